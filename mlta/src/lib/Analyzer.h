@@ -21,6 +21,7 @@
 #include <string>
 
 #include "Common.h"
+#include "FlatHashMap.h"
 
 
 // 
@@ -64,7 +65,7 @@ struct GlobalContext {
 	CallerMap Callers;
 
 	// Map function signature to functions
-	DenseMap<size_t, FuncSet>sigFuncsMap;
+	FlatHashMap<FuncSet>sigFuncsMap;
 
 	// Indirect call instructions.
 	std::vector<CallInst *>IndirectCallInsts;
@@ -36,6 +36,7 @@ class CallGraphPass :
 			MLTA(Ctx_) {
 
 				LoadElementsStructNameMap(Ctx->Modules);
+				reserveTypeTables(Ctx->Modules);
 				MIdx = 0;
 			}
 
@@ -2,14 +2,17 @@
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/Operator.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Format.h>
 #include <fstream>
 #include <regex>
 #include "Common.h"
 #include "Config.h"
 
 
-// Map from struct elements to its name
-static map<string, set<StringRef>>elementsStructNameMap;
+// Map from struct elements to its name. Keyed by the element string
+// itself, a hash key would merge the names of colliding layouts
+static StringMap<set<StringRef>>elementsStructNameMap;
 
 bool trimPathSlash(string &path, int slash) {
 	while (slash > 0) {
@@ -335,6 +338,15 @@ void LoadElementsStructNameMap(
 	}
 }
 
+void printElementsStructNameMapStats(raw_ostream &OS) {
+	OS << "elementsStructNameMap: entries " << elementsStructNameMap.size()
+		<< ", buckets " << elementsStructNameMap.getNumBuckets()
+		<< ", load factor "
+		<< format("%.3f", elementsStructNameMap.getNumBuckets() ?
+				(double)elementsStructNameMap.size()
+				/ elementsStructNameMap.getNumBuckets() : 0.0) << "\n";
+}
+
 void cleanString(string &str) {
 	// process string
 	// remove c++ class type added by compiler
@@ -442,10 +454,9 @@ void structTypeHash(StructType *STy, set<size_t> &HSet) {
     HSet.insert(str_hash(ty_str));
   }
   else {
-    string sstr = structTyStr(STy);
-    if (elementsStructNameMap.find(sstr)
-        != elementsStructNameMap.end()) {
-      for (auto SStr : elementsStructNameMap[sstr]) {
+    auto SI = elementsStructNameMap.find(structTyStr(STy));
+    if (SI != elementsStructNameMap.end()) {
+      for (auto SStr : SI->second) {
         ty_str = SStr.str();
         HSet.insert(str_hash(ty_str));
       }
@@ -465,10 +476,9 @@ size_t typeHash(Type *Ty) {
       ty_str = STy->getName().str();
     }
     else {
-      string sstr = structTyStr(STy);
-      if (elementsStructNameMap.find(sstr)
-          != elementsStructNameMap.end()) {
-        ty_str = elementsStructNameMap[sstr].begin()->str();
+      auto SI = elementsStructNameMap.find(structTyStr(STy));
+      if (SI != elementsStructNameMap.end()) {
+        ty_str = SI->second.begin()->str();
       }
     }
   }
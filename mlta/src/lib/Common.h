@@ -103,6 +103,7 @@ bool trimPathSlash(string &path, int slash);
 int64_t getGEPOffset(const Value *V, const DataLayout *DL);
 void LoadElementsStructNameMap(
 		vector<pair<Module*, StringRef>> &Modules);
+void printElementsStructNameMapStats(raw_ostream &OS);
 
 //
 // Common data structures
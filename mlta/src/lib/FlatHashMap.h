@@ -0,0 +1,194 @@
+#ifndef _FLAT_HASH_MAP_H
+#define _FLAT_HASH_MAP_H
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// Open-addressing hash table for the MLTA type tables. Keys are type
+// and field hashes (size_t), so entries are stored inline in one
+// bucket array with linear probing instead of one heap node per key.
+// Entries are never erased.
+//
+template <typename ValueT>
+class FlatHashMap {
+
+	public:
+		typedef std::pair<size_t, ValueT> value_type;
+
+	private:
+		std::vector<value_type> Buckets;
+		std::vector<bool> Used;
+		size_t NumEntries = 0;
+
+		// Keys are hashes already, but the low bits of hashIdxHash()
+		// results are poorly spread
+		static size_t mix(size_t Key) {
+			Key ^= Key >> 33;
+			Key *= 0xff51afd7ed558ccdULL;
+			Key ^= Key >> 33;
+			return Key;
+		}
+
+		size_t home(size_t Key) const {
+			return mix(Key) & (Buckets.size() - 1);
+		}
+
+		// Bucket holding Key, or the empty bucket it would be put in
+		size_t lookup(size_t Key) const {
+			size_t B = home(Key);
+			while (Used[B] && Buckets[B].first != Key)
+				B = (B + 1) & (Buckets.size() - 1);
+			return B;
+		}
+
+		void grow(size_t NumBuckets) {
+			std::vector<value_type> OldBuckets;
+			std::vector<bool> OldUsed;
+			OldBuckets.swap(Buckets);
+			OldUsed.swap(Used);
+
+			Buckets.resize(NumBuckets);
+			Used.assign(NumBuckets, false);
+			for (size_t i = 0; i < OldBuckets.size(); ++i) {
+				if (!OldUsed[i])
+					continue;
+				size_t B = lookup(OldBuckets[i].first);
+				Buckets[B] = std::move(OldBuckets[i]);
+				Used[B] = true;
+			}
+		}
+
+	public:
+		template <bool IsConst>
+		class Iterator {
+			typedef typename std::conditional<IsConst,
+					const FlatHashMap, FlatHashMap>::type MapT;
+			typedef typename std::conditional<IsConst,
+					const value_type, value_type>::type EntryT;
+
+			MapT *Map;
+			size_t Idx;
+
+			void skipEmpty() {
+				while (Idx < Map->Buckets.size() && !Map->Used[Idx])
+					++Idx;
+			}
+
+		public:
+			Iterator(MapT *M, size_t I) : Map(M), Idx(I) { skipEmpty(); }
+
+			EntryT &operator*() const { return Map->Buckets[Idx]; }
+			EntryT *operator->() const { return &Map->Buckets[Idx]; }
+			Iterator &operator++() { ++Idx; skipEmpty(); return *this; }
+			bool operator==(const Iterator &I) const { return Idx == I.Idx; }
+			bool operator!=(const Iterator &I) const { return Idx != I.Idx; }
+		};
+		typedef Iterator<false> iterator;
+		typedef Iterator<true> const_iterator;
+
+		FlatHashMap() { grow(16); }
+
+		iterator begin() { return iterator(this, 0); }
+		iterator end() { return iterator(this, Buckets.size()); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, Buckets.size()); }
+
+		size_t size() const { return NumEntries; }
+		bool empty() const { return NumEntries == 0; }
+
+		// Make room for N entries without rehashing
+		void reserve(size_t N) {
+			size_t NumBuckets = llvm::PowerOf2Ceil(N * 4 / 3 + 1);
+			if (NumBuckets > Buckets.size())
+				grow(NumBuckets);
+		}
+
+		iterator find(size_t Key) {
+			size_t B = lookup(Key);
+			return Used[B] ? iterator(this, B) : end();
+		}
+
+		const_iterator find(size_t Key) const {
+			size_t B = lookup(Key);
+			return Used[B] ? const_iterator(this, B) : end();
+		}
+
+		size_t count(size_t Key) const {
+			return Used[lookup(Key)];
+		}
+
+		std::pair<iterator, bool> insert(size_t Key) {
+			size_t B = lookup(Key);
+			if (Used[B])
+				return std::make_pair(iterator(this, B), false);
+
+			// Keep the load factor under 3/4
+			if ((NumEntries + 1) * 4 > Buckets.size() * 3) {
+				grow(Buckets.size() * 2);
+				B = lookup(Key);
+			}
+			Buckets[B].first = Key;
+			Buckets[B].second = ValueT();
+			Used[B] = true;
+			++NumEntries;
+			return std::make_pair(iterator(this, B), true);
+		}
+
+		ValueT &operator[](size_t Key) {
+			return insert(Key).first->second;
+		}
+
+		// Print occupancy and probe lengths of the table
+		void printStats(llvm::raw_ostream &OS, llvm::StringRef Name) const {
+			size_t TotalProbes = 0, MaxProbes = 0;
+			for (size_t i = 0; i < Buckets.size(); ++i) {
+				if (!Used[i])
+					continue;
+				size_t Probes = ((i - home(Buckets[i].first))
+						& (Buckets.size() - 1)) + 1;
+				TotalProbes += Probes;
+				if (Probes > MaxProbes)
+					MaxProbes = Probes;
+			}
+			OS << Name << ": entries " << NumEntries
+				<< ", buckets " << Buckets.size()
+				<< ", load factor "
+				<< llvm::format("%.3f", (double)NumEntries / Buckets.size())
+				<< ", avg probes "
+				<< llvm::format("%.3f", NumEntries ?
+						(double)TotalProbes / NumEntries : 0.0)
+				<< ", max probes " << MaxProbes << "\n";
+		}
+};
+
+//
+// Set of type hashes on top of FlatHashMap
+//
+class FlatHashSet {
+
+	private:
+		struct Empty {};
+		FlatHashMap<Empty> Map;
+
+	public:
+		typedef FlatHashMap<Empty>::const_iterator const_iterator;
+
+		const_iterator end() const { return Map.end(); }
+		const_iterator find(size_t Key) const { return Map.find(Key); }
+		size_t count(size_t Key) const { return Map.count(Key); }
+		size_t size() const { return Map.size(); }
+		void reserve(size_t N) { Map.reserve(N); }
+		bool insert(size_t Key) { return Map.insert(Key).second; }
+
+		void printStats(llvm::raw_ostream &OS, llvm::StringRef Name) const {
+			Map.printStats(OS, Name);
+		}
+};
+
+#endif
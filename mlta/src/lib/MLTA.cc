@@ -823,6 +823,14 @@ void MLTA::printTargets(FuncSet &FS, CallInst *CI) {
 bool MLTA::getBaseTypeChain(list<typeidx_t> &Chain, Value *V,
 		bool &Complete) {
 
+	auto CI = BaseTypeChainMap.find(V);
+	if (CI != BaseTypeChainMap.end()) {
+		Chain.insert(Chain.end(), CI->second.first.begin(),
+				CI->second.first.end());
+		Complete = CI->second.second;
+		return true;
+	}
+
 	Complete = true;
 	Value *CV = V, *NextV = NULL;
 	list<typeidx_t> TyList;
@@ -865,6 +873,7 @@ bool MLTA::getBaseTypeChain(list<typeidx_t> &Chain, Value *V,
 		typeCapSet.insert(typeHash(Chain.back().first));
 	}
 
+	BaseTypeChainMap[V] = make_pair(Chain, Complete);
 	return true;
 }
 
@@ -1191,6 +1200,25 @@ bool MLTA::nextLayerBaseType(Value *V, list<typeidx_t> &TyList,
 	return false;
 }
 
+// Memoized nextLayerBaseType() starting from an empty visited set
+bool MLTA::getLayerTypes(Value *V, list<typeidx_t> &TyList,
+		Value * &NextV) {
+
+	auto LI = LayerTypesMap.find(V);
+	if (LI == LayerTypesMap.end()) {
+		LayerTypes LT;
+		set<Value *> Visited;
+		LT.NextV = NULL;
+		LT.Found = nextLayerBaseType(V, LT.TyList, LT.NextV, Visited);
+		LI = LayerTypesMap.insert(make_pair(V, LT)).first;
+	}
+
+	TyList.insert(TyList.end(), LI->second.TyList.begin(),
+			LI->second.TyList.end());
+	NextV = LI->second.NextV;
+	return LI->second.Found;
+}
+
 bool MLTA::getDependentTypes(Type *Ty, int Idx, 
 		set<hashidx_t> &PropSet) {
 
@@ -1293,8 +1321,7 @@ bool MLTA::findCalleesWithMLTA(CallInst *CI,
 		}
 #endif
 
-		set<Value *> Visited;
-		nextLayerBaseType(CV, TyList, NextV, Visited);
+		getLayerTypes(CV, TyList, NextV);
 		if (TyList.empty()) {
 			if (LayerNo == 1) {
 				//printSourceCodeInfo(CI, "NOBASE");
@@ -1403,6 +1430,34 @@ bool MLTA::findCalleesWithMLTA(CallInst *CI,
 	return true;
 }
 
+void MLTA::reserveTypeTables(ModuleList &Modules) {
+
+	// Only address-taken functions get a signature entry
+	size_t NumStructs = 0, NumFuncs = 0;
+	for (auto M : Modules) {
+		NumStructs += M.first->getIdentifiedStructTypes().size();
+		for (Function &F : *M.first)
+			if (F.hasAddressTaken())
+				++NumFuncs;
+	}
+
+	typeIdxFuncsMap.reserve(NumStructs);
+	typeIdxPropMap.reserve(NumStructs);
+	typeEscapeSet.reserve(NumStructs);
+	typeCapSet.reserve(NumStructs + NumFuncs);
+	Ctx->sigFuncsMap.reserve(NumFuncs);
+}
+
+void MLTA::printTableStats(raw_ostream &OS) {
+
+	typeIdxFuncsMap.printStats(OS, "typeIdxFuncsMap");
+	typeIdxPropMap.printStats(OS, "typeIdxPropMap");
+	typeEscapeSet.printStats(OS, "typeEscapeSet");
+	typeCapSet.printStats(OS, "typeCapSet");
+	Ctx->sigFuncsMap.printStats(OS, "sigFuncsMap");
+	printElementsStructNameMapStats(OS);
+}
+
 
 
 
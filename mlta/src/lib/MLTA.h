@@ -25,12 +25,12 @@ class MLTA {
 		// Important data structures for type confinement, propagation,
 		// and escapes. 
 		////////////////////////////////////////////////////////////////
-		DenseMap<size_t, map<int, FuncSet>>typeIdxFuncsMap;
-		map<size_t, map<int, set<hashidx_t>>>typeIdxPropMap;
-		set<size_t>typeEscapeSet;
+		FlatHashMap<map<int, FuncSet>>typeIdxFuncsMap;
+		FlatHashMap<map<int, set<hashidx_t>>>typeIdxPropMap;
+		FlatHashSet typeEscapeSet;
 		// Cap type: We cannot know where the type can be futher
 		// propagated to. Do not include idx in the hash
-		set<size_t>typeCapSet;
+		FlatHashSet typeCapSet;
 
 
 		////////////////////////////////////////////////////////////////
@@ -49,6 +49,18 @@ class MLTA {
 		// Matched icall types -- to avoid repeatation
 		DenseMap<size_t, FuncSet> MatchedICallTypeMap;
 
+		// Resolved layer types of a value -- the same pointer operands
+		// are resolved for many indirect calls
+		struct LayerTypes {
+			list<typeidx_t> TyList;
+			Value *NextV;
+			bool Found;
+		};
+		DenseMap<Value *, LayerTypes> LayerTypesMap;
+		// Base-type chain of a value and whether it is complete (i.e.,
+		// does not escape)
+		DenseMap<Value *, pair<list<typeidx_t>, bool>> BaseTypeChainMap;
+
 		// Set of target types
 		set<size_t>TTySet;
 
@@ -81,6 +93,8 @@ class MLTA {
 				Value * &NextV, set<Value *> &Visited);
 		bool nextLayerBaseTypeWL(Value *V, list<typeidx_t> &TyList, 
 				Value * &NextV);
+		bool getLayerTypes(Value *V, list<typeidx_t> &TyList,
+				Value * &NextV);
 		bool getGEPLayerTypes(GEPOperator *GEP, list<typeidx_t> &TyList);
 		bool getBaseTypeChain(list<typeidx_t> &Chain, Value *V, 
 				bool &Complete);
@@ -138,6 +152,11 @@ class MLTA {
 			Ctx = Ctx_;
 		}
 
+		// Size the type tables for the structs and functions of the
+		// modules up front
+		void reserveTypeTables(ModuleList &Modules);
+		void printTableStats(raw_ostream &OS);
+
 };
 
 #endif
@@ -0,0 +1,266 @@
+//===-- MLTABench.cc - benchmark of the MLTA primitives --------===//
+//
+// It times the hashing functions and the type confinement and
+// callee resolution of MLTA on bitcode files and/or a synthetic
+// module, and prints the results as JSON.
+//
+//===-----------------------------------------------------------===//
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/TypeFinder.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "Analyzer.h"
+#include "CallGraph.h"
+#include "Config.h"
+
+using namespace llvm;
+
+cl::list<std::string> InputFilenames(
+	cl::Positional, cl::ZeroOrMore, cl::desc("<input bitcode files>"));
+
+cl::opt<unsigned> Repeat(
+	"repeat", cl::desc("Number of rounds for the hash functions"),
+	cl::init(100));
+
+cl::opt<unsigned> SynStructs(
+	"synthetic-structs", cl::desc("Number of struct types of the synthetic module"),
+	cl::init(0));
+
+cl::opt<unsigned> SynFuncPtrs(
+	"synthetic-fptrs", cl::desc("Number of address-taken functions of the synthetic module"),
+	cl::init(0));
+
+cl::opt<unsigned> SynICalls(
+	"synthetic-icalls", cl::desc("Number of indirect calls of the synthetic module"),
+	cl::init(0));
+
+cl::opt<std::string> OutputFilename(
+	"o", cl::desc("Output JSON file"), cl::init("-"),
+	cl::value_desc("filename"));
+
+//
+// Build a module where every struct type holds a function pointer of
+// the same signature. Functions are confined to the structs through
+// global initializers, and every indirect call loads the pointer from
+// one of the structs, so MLTA has to narrow the first-layer targets.
+//
+static Module *buildSyntheticModule(LLVMContext &C) {
+
+	Module *M = new Module("synthetic", C);
+	Type *Int32Ty = Type::getInt32Ty(C);
+	Type *Int8PtrTy = Type::getInt8PtrTy(C);
+	FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), {Int8PtrTy}, false);
+	PointerType *FPtrTy = FTy->getPointerTo();
+
+	unsigned NumStructs = SynStructs ? (unsigned)SynStructs : 1;
+	vector<StructType *> Structs;
+	for (unsigned i = 0; i < NumStructs; ++i)
+		Structs.push_back(StructType::create(C, {Int32Ty, FPtrTy, Int8PtrTy},
+					"struct.S" + to_string(i)));
+
+	for (unsigned i = 0; i < SynFuncPtrs; ++i) {
+		Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage,
+				"f" + to_string(i), M);
+		IRBuilder<> B(BasicBlock::Create(C, "entry", F));
+		B.CreateRetVoid();
+
+		StructType *STy = Structs[i % NumStructs];
+		Constant *Init = ConstantStruct::get(STy, {ConstantInt::get(Int32Ty, i),
+				F, ConstantPointerNull::get(cast<PointerType>(Int8PtrTy))});
+		new GlobalVariable(*M, STy, false, GlobalValue::ExternalLinkage,
+				Init, "g" + to_string(i));
+	}
+
+	for (unsigned i = 0; i < SynICalls; ++i) {
+		StructType *STy = Structs[i % NumStructs];
+		FunctionType *CTy = FunctionType::get(Type::getVoidTy(C),
+				{STy->getPointerTo(), Int8PtrTy}, false);
+		Function *F = Function::Create(CTy, GlobalValue::ExternalLinkage,
+				"caller" + to_string(i), M);
+		IRBuilder<> B(BasicBlock::Create(C, "entry", F));
+		Value *FP = B.CreateLoad(FPtrTy, B.CreateStructGEP(STy, F->getArg(0), 1));
+		B.CreateCall(FTy, FP, {F->getArg(1)});
+		B.CreateRetVoid();
+	}
+
+	return M;
+}
+
+// Expose the protected MLTA primitives
+class MLTABench : public CallGraphPass {
+
+	public:
+		MLTABench(GlobalContext *Ctx_)
+			: IterativeModulePass(Ctx_, "MLTABench"),
+			MLTA(Ctx_), CallGraphPass(Ctx_) {}
+
+		using MLTA::typeConfineInFunction;
+		using MLTA::findCalleesWithMLTA;
+};
+
+template <typename F>
+static json::Object timeIt(uint64_t Calls, F Fn) {
+
+	auto Start = chrono::steady_clock::now();
+	Fn();
+	auto End = chrono::steady_clock::now();
+	double NS = chrono::duration<double, nano>(End - Start).count();
+
+	return json::Object{
+		{"calls", (int64_t)Calls},
+		{"total_ms", NS / 1e6},
+		{"ns_per_call", Calls ? NS / Calls : 0.0},
+	};
+}
+
+int main(int argc, char **argv) {
+
+	cl::ParseCommandLineOptions(argc, argv, "MLTA benchmark\n");
+	SMDiagnostic Err;
+	GlobalContext GlobalCtx;
+
+	for (unsigned i = 0; i < InputFilenames.size(); ++i) {
+
+		LLVMContext *LLVMCtx = new LLVMContext();
+		std::unique_ptr<Module> M = parseIRFile(InputFilenames[i], Err, *LLVMCtx);
+
+		if (M == NULL) {
+			errs() << argv[0] << ": error loading file '"
+				<< InputFilenames[i] << "'\n";
+			return 1;
+		}
+
+		Module *Module = M.release();
+		StringRef MName = StringRef(strdup(InputFilenames[i].data()));
+		GlobalCtx.Modules.push_back(std::make_pair(Module, MName));
+		GlobalCtx.ModuleMaps[Module] = InputFilenames[i];
+	}
+
+	if (SynStructs || SynFuncPtrs || SynICalls) {
+		Module *Module = buildSyntheticModule(*new LLVMContext());
+		GlobalCtx.Modules.push_back(std::make_pair(Module, Module->getName()));
+		GlobalCtx.ModuleMaps[Module] = Module->getName();
+	}
+
+	if (GlobalCtx.Modules.empty()) {
+		errs() << argv[0] << ": no input bitcode file or synthetic module\n";
+		return 1;
+	}
+
+	vector<Type *> Types;
+	vector<Function *> Funcs;
+	vector<Function *> DefinedFuncs;
+	vector<CallInst *> ICalls;
+	for (auto M : GlobalCtx.Modules) {
+		// Literal structs too, typeHash looks them up by their elements
+		TypeFinder StructTypes;
+		StructTypes.run(*M.first, false);
+		for (StructType *STy : StructTypes)
+			if (!STy->isOpaque())
+				Types.push_back(STy);
+		for (Function &F : *M.first) {
+			Funcs.push_back(&F);
+			if (!F.isDeclaration())
+				DefinedFuncs.push_back(&F);
+			for (inst_iterator i = inst_begin(F), e = inst_end(F); i != e; ++i)
+				if (CallInst *CI = dyn_cast<CallInst>(&*i))
+					if (CI->isIndirectCall())
+						ICalls.push_back(CI);
+		}
+	}
+
+	json::Object Results;
+	size_t Sink = 0;
+
+	// typeHash of a literal struct looks up the names of named structs
+	// with the same elements, so the map has to be loaded first
+	LoadElementsStructNameMap(GlobalCtx.Modules);
+
+	Results["typeHash"] = timeIt(Types.size() * Repeat, [&]() {
+		for (unsigned r = 0; r < Repeat; ++r)
+			for (Type *Ty : Types)
+				Sink += typeHash(Ty);
+	});
+
+	Results["funcHash"] = timeIt(Funcs.size() * Repeat, [&]() {
+		for (unsigned r = 0; r < Repeat; ++r)
+			for (Function *F : Funcs)
+				Sink += funcHash(F, false);
+	});
+
+	Results["callHash"] = timeIt(ICalls.size() * Repeat, [&]() {
+		for (unsigned r = 0; r < Repeat; ++r)
+			for (CallInst *CI : ICalls)
+				Sink += callHash(CI);
+	});
+
+	// Type confinement on empty type tables
+	{
+		GlobalContext ConfineCtx;
+		ConfineCtx.Modules = GlobalCtx.Modules;
+		MLTABench Bench(&ConfineCtx);
+		for (auto M : ConfineCtx.Modules) {
+			Bench.DLMap[M.first] = &(M.first->getDataLayout());
+			Bench.Int8PtrTy[M.first] = Type::getInt8PtrTy(M.first->getContext());
+			Bench.IntPtrTy[M.first] = Bench.DLMap[M.first]->getIntPtrType(M.first->getContext());
+		}
+		Results["typeConfineInFunction"] = timeIt(DefinedFuncs.size(), [&]() {
+			for (Function *F : DefinedFuncs)
+				Bench.typeConfineInFunction(F);
+		});
+	}
+
+	// Callee resolution once all modules are initialized, without the
+	// results cached by the iterative pass
+	{
+		MLTABench Bench(&GlobalCtx);
+		for (auto M : GlobalCtx.Modules)
+			Bench.doInitialization(M.first);
+		uint64_t NumTargets = 0;
+		Results["findCalleesWithMLTA"] = timeIt(ICalls.size(), [&]() {
+			for (CallInst *CI : ICalls) {
+				FuncSet FS;
+				Bench.findCalleesWithMLTA(CI, FS);
+				NumTargets += FS.size();
+			}
+		});
+		Results["findCalleesWithMLTA"].getAsObject()->insert(
+				{"targets", (int64_t)NumTargets});
+	}
+
+	json::Array Inputs;
+	for (auto M : GlobalCtx.Modules)
+		Inputs.push_back(M.second.str());
+
+	json::Object Out{
+		{"inputs", std::move(Inputs)},
+		{"structs", (int64_t)Types.size()},
+		{"functions", (int64_t)Funcs.size()},
+		{"indirect_calls", (int64_t)ICalls.size()},
+		{"repeat", (int64_t)Repeat},
+		{"results", std::move(Results)},
+		{"checksum", (int64_t)(Sink & 0xffff)},
+	};
+
+	std::error_code EC;
+	raw_fd_ostream OS(OutputFilename, EC, sys::fs::OF_Text);
+	if (EC) {
+		errs() << argv[0] << ": " << EC.message() << "\n";
+		return 1;
+	}
+	OS << formatv("{0:2}", json::Value(std::move(Out))) << "\n";
+
+	return 0;
+}
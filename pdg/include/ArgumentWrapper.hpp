@@ -1,8 +1,10 @@
 #ifndef ARGUMENTWRAPPER_H_
 #define ARGUMENTWRAPPER_H_
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/Argument.h"
 #include "InstructionWrapper.hpp"
 #include "PDGEnums.hpp"
+#include "TypeTree.hpp"
 #include "tree.hh"
 
 namespace pdg
@@ -17,6 +19,8 @@ private:
   tree<InstructionWrapper *> actualInTree;
   tree<InstructionWrapper *> actualOutTree;
   std::vector<std::pair<InstructionWrapper*, InstructionWrapper*>> paramCallInstPairs;
+  // shape of the formal/actual trees, shared with every argument of the same type
+  const TypeTree *typeTree = nullptr;
 public:
   ArgumentWrapper() = delete;
   explicit ArgumentWrapper(llvm::Argument *arg);
@@ -24,7 +28,10 @@ public:
   tree<InstructionWrapper *> &getTree(TreeType treeTy);
   std::vector<std::pair<InstructionWrapper *, InstructionWrapper *>> getParamCallInstPair() const { return paramCallInstPairs; }
   void addParamCallInstW(std::pair<InstructionWrapper *, InstructionWrapper *> paramCallPair) { paramCallInstPairs.push_back(paramCallPair); }
-  void copyTree(const tree<InstructionWrapper *> &srcTree, TreeType treeTy);
+  // builds the tree of treeTy from shape, makeNode creates the wrapper of a node
+  void buildTree(const TypeTree &shape, TreeType treeTy, llvm::function_ref<InstructionWrapper *(const TypeTree::Node &)> makeNode);
+  // builds the tree of treeTy from the shape of the formal trees of srcArgW
+  void copyTree(const ArgumentWrapper &srcArgW, TreeType treeTy);
   tree<InstructionWrapper *>::iterator tree_begin(TreeType treeTy);
   tree<InstructionWrapper *>::iterator tree_end(TreeType treeTy);
 };
@@ -0,0 +1,35 @@
+#ifndef CONTROLDEPENDENCEINFO_H_
+#define CONTROLDEPENDENCEINFO_H_
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include <vector>
+
+namespace pdg
+{
+// Block level control dependences of a function, computed from its postdominance
+// frontier (Cytron et al.): block X is control dependent on the terminator of A
+// iff A is in the postdominance frontier of X, which includes a loop controlled by
+// A itself. The frontiers are built bottom up over the post-dominator tree in one
+// pass, instead of walking the tree for every CFG edge. The PDT is only used
+// during construction, so one tree can serve every graph of the function.
+class ControlDependenceInfo
+{
+public:
+  ControlDependenceInfo(llvm::Function &F, const llvm::PostDominatorTree &PDT);
+
+  // blocks that run whenever F runs: the entry block and its postdominators
+  llvm::ArrayRef<llvm::BasicBlock *> getEntryDependents() const { return entryDependents; }
+  // blocks control dependent on the terminator of BB, possibly BB itself
+  llvm::ArrayRef<llvm::BasicBlock *> getDependents(const llvm::BasicBlock *BB) const;
+
+private:
+  std::vector<llvm::BasicBlock *> entryDependents;
+  llvm::DenseMap<const llvm::BasicBlock *, llvm::SmallVector<llvm::BasicBlock *, 4>> dependents;
+};
+} // namespace pdg
+
+#endif
@@ -6,11 +6,15 @@
 #include "llvm/Pass.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/GraphWriter.h"
+#include "algorithm"
 #include "map"
+#include "set"
+#include "unordered_map"
 
 #include "DependencyGraph.hpp"
 #include "CallWrapper.hpp"
 #include "FunctionWrapper.hpp"
+#include "FunctionInstMap.hpp"
 
 namespace pdg
 {
@@ -18,15 +22,17 @@ namespace pdg
   {
   public:
     using cgdNode = pdg::DependencyNode<pdg::InstructionWrapper>;
-    ControlDependencyGraph2(llvm::Function *F, llvm::PostDominatorTree *PDT)
+    // blockLevel为true时每个BB只对应其terminator一个node，BB中其他指令的查询映射到该node
+    // 使用自己的InstructionWrapper而不是PDGUtils单例，不同函数的cdg可以并行构建
+    ControlDependencyGraph2(llvm::Function *F, llvm::PostDominatorTree *PDT, bool blockLevel = true)
+        : instMap(F)
     {
       CDG = new DependencyGraph<InstructionWrapper>();
       this->PDT = PDT;
       this->Func = F;
+      this->blockLevel = blockLevel;
       this->dumpOnlyDep = false;
-      PDGUtils::getInstance().constructInstMap(*F);
       computeDependencies(*F);
-      initDijkstra();
     }
 
     ~ControlDependencyGraph2()
@@ -35,22 +41,54 @@ namespace pdg
     }
 
     void computeDependencies(llvm::Function &F);
+    bool isBlockLevel() const { return blockLevel; }
+    llvm::Function *getFunction() const { return Func; }
     void addInstToBBDependency(InstructionWrapper *from, llvm::BasicBlock *to, DependencyType depType);
     void addBBToBBDependency(llvm::BasicBlock *from, llvm::BasicBlock *to, DependencyType depType);
     DependencyGraph<InstructionWrapper> *_getCDG() { return CDG; }
+    // ins在图中对应的node
+    cgdNode *getNodeForInst(llvm::Instruction *ins);
     void dump(std::string fileName);
-    //TODO：我们需要更高效的算法,在此之前我们仅计算最短的path，而不是所有path
-    void getRDep(llvm::Instruction *ins,std::vector<std::vector<llvm::Instruction *>>&pathVector);
-    void initDijkstra();
-    std::map<cgdNode *, cgdNode *> pre;
-    std::map<cgdNode *, uint64_t> dis;
+    // 以src为起点的最短路树，边权均为1，由BFS得到
+    struct PathTree
+    {
+      std::unordered_map<cgdNode *, cgdNode *> pre;
+      std::unordered_map<cgdNode *, uint64_t> dis;
+    };
+    // 每个src的最短路树只计算一次
+    const PathTree &getPathTree(cgdNode *src);
+    // 从入口到ins的最短cdg path，不包括入口与ins本身
+    void getRDep(llvm::Instruction *ins, std::vector<std::vector<llvm::Instruction *>> &pathVector);
+    // 从入口到ins的至多k条最短的简单cdg path（Yen算法），按长度递增
+    void getKRDep(llvm::Instruction *ins, unsigned k, std::vector<std::vector<llvm::Instruction *>> &pathVector);
     bool dumpOnlyDep;
 
   private:
+    friend class DependencyGraphCache;
+    // 由DependencyGraphCache从磁盘读入，图不经过计算，也没有PDT
+    ControlDependencyGraph2(llvm::Function *F, bool blockLevel) : instMap(F)
+    {
+      CDG = new DependencyGraph<InstructionWrapper>();
+      this->PDT = nullptr;
+      this->Func = F;
+      this->blockLevel = blockLevel;
+      this->dumpOnlyDep = false;
+    }
+
+    FunctionInstMap instMap;
     DependencyGraph<InstructionWrapper> *CDG;
     llvm::PostDominatorTree *PDT;
     llvm::Function *Func;
-    
+    bool blockLevel;
+    std::map<cgdNode *, PathTree> pathTrees;
+
+    cgdNode *getEntry();
+    bool bfs(cgdNode *src, cgdNode *dst, PathTree &tree,
+             const std::set<cgdNode *> &bannedNodes,
+             const std::set<std::pair<cgdNode *, cgdNode *>> &bannedEdges);
+    static std::vector<cgdNode *> treePath(const PathTree &tree, cgdNode *dst);
+    static void toInstPath(const std::vector<cgdNode *> &nodes, std::vector<llvm::Instruction *> &path);
+
   };
 }
 
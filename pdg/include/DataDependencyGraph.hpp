@@ -4,15 +4,20 @@
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Instructions.h"
 
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Analysis/CFLSteensAliasAnalysis.h"
 #include "llvm/Analysis/CFLAndersAliasAnalysis.h"
 
 #include "DependencyGraph.hpp"
 #include "CallWrapper.hpp"
 #include "FunctionWrapper.hpp"
+#include "FunctionInstMap.hpp"
+#include <memory>
 
 namespace pdg
 {
@@ -44,16 +49,34 @@ public:
   DependencyNode<InstructionWrapper> *getNodeByData(llvm::Instruction *inst);
   typename DependencyNode<InstructionWrapper>::DependencyLinkList getNodeDepList(llvm::Instruction *inst);
   virtual bool runOnFunction(llvm::Function &Func) override;
+  // Build the DDG of F outside the pass manager, with its own instruction wrappers
+  // instead of the PDGUtils maps. The analyses are only used during the call.
+  void buildLocal(llvm::Function &F, llvm::CFLAndersAAResult &andersAA,
+                  llvm::CFLSteensAAResult &steenAA, llvm::MemoryDependenceResults &MD);
   virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
   virtual llvm::StringRef getPassName() const override { return "Data Dependency Graph"; }
   DependencyGraph<InstructionWrapper> *_getDDG() {return DDG;}
 
+  llvm::Function *getFunction() const { return Func; }
+
 private:
   DependencyGraph<InstructionWrapper> *DDG;
   llvm::Function *Func;
+  FunctionWrapper *funcW = nullptr;
+  // only set by buildLocal
+  std::unique_ptr<FunctionInstMap> localInsts;
+  std::unique_ptr<FunctionWrapper> localFuncW;
   llvm::CFLSteensAAResult *steenAA;
   llvm::CFLAndersAAResult *andersAA;
   llvm::MemoryDependenceResults *MD;
+  // stores of Func by underlying object, see getAliasBucket. Built on first use
+  // for each function, so getRAWDepList can be called on its own
+  llvm::MapVector<const llvm::Value *, std::vector<llvm::StoreInst *>> storeBuckets;
+  const llvm::Function *storeBucketsFunc = nullptr;
+
+  const llvm::MapVector<const llvm::Value *, std::vector<llvm::StoreInst *>> &getStoreBuckets();
+
+  InstructionWrapper *getInstW(llvm::Instruction *inst);
 };
 } // namespace pdg
 
@@ -2,6 +2,8 @@
 #define DEPENDENCYGRAPH_H_
 #include "DependencyNode.hpp"
 #include "PDGUtils.hpp"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Allocator.h"
 #include <map>
 #include <set>
 #include <exception>
@@ -15,10 +17,16 @@ public:
   using nodes_iterator = typename std::vector<DependencyNode<InstructionWrapper> *>::iterator;
   using const_nodes_iterator = typename std::vector<DependencyNode<InstructionWrapper> *>::const_iterator;
   DependencyGraph() = default;
+  DependencyGraph(const DependencyGraph &) = delete;
+  DependencyGraph &operator=(const DependencyGraph &) = delete;
   ~DependencyGraph();
-  std::vector<DependencyNode<NodeT> *> getNodeSet() const { return nodeSet; }
+  const std::vector<DependencyNode<NodeT> *> &getNodeSet() const { return nodeSet; }
+  unsigned size() const { return nodeSet.size(); }
   void addNode(const NodeT *dNode);
   DependencyNode<NodeT> *getNodeByData(const NodeT *data);
+  DependencyNode<NodeT> *getNodeById(unsigned id) const { return nodeSet[id]; }
+  // nullptr when data has no node, unlike getNodeByData it never adds one
+  DependencyNode<NodeT> *lookupNode(const NodeT *data) const;
   typename DependencyNode<NodeT>::DependencyLinkList getNodeDepList(const NodeT *data);
   void addDependency(const NodeT *from, const NodeT *to, DependencyType depType);
   bool isDepends(const NodeT *data1, const NodeT *data2);
@@ -27,8 +35,10 @@ public:
   nodes_iterator end_child() { return nodes_iterator(nodeSet.end()); }
 
 private:
+  // nodes live in the arena and are freed together with the graph, their ids index nodeSet
+  llvm::SpecificBumpPtrAllocator<DependencyNode<NodeT>> nodeArena;
   std::vector<DependencyNode<NodeT> *> nodeSet;
-  std::map<const NodeT *, DependencyNode<NodeT> *> DataToNodeMap;
+  llvm::DenseMap<const NodeT *, unsigned> DataToNodeMap;
 };
 } // namespace pdg
 
@@ -0,0 +1,37 @@
+#ifndef DEPENDENCYGRAPHBUILDER_H_
+#define DEPENDENCYGRAPHBUILDER_H_
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/Function.h"
+
+#include "ControlDependencyGraph2.hpp"
+#include "DataDependencyGraph.hpp"
+#include "DependencyGraphCache.hpp"
+#include <memory>
+#include <vector>
+
+namespace pdg
+{
+// dependence graphs of one function, built by buildDependencyGraphs
+struct FunctionDependencies
+{
+  llvm::Function *func = nullptr;
+  // nullptr when the CDG was loaded from the cache
+  std::unique_ptr<llvm::PostDominatorTree> PDT;
+  std::unique_ptr<ControlDependencyGraph2> CDG;
+  std::unique_ptr<DataDependencyGraph> DDG;
+};
+
+// Build the CDG of every function in funcs on a thread pool of `threads` threads,
+// 0 for all cores, and its DDG as well when withDDG is set. result[i] belongs to
+// funcs[i], declarations are left empty. The alias analyses behind the DDGs add
+// value handles to the shared LLVMContext, so the DDGs are built one by one on
+// the calling thread after the CDGs. With a cache, CDGs are loaded from it when
+// possible and the ones that had to be built are stored into it. DDGs are always
+// built.
+std::vector<FunctionDependencies> buildDependencyGraphs(llvm::ArrayRef<llvm::Function *> funcs,
+                                                        bool withDDG = false, unsigned threads = 0,
+                                                        DependencyGraphCache *cache = nullptr);
+} // namespace pdg
+
+#endif
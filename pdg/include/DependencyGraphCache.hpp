@@ -0,0 +1,41 @@
+#ifndef DEPENDENCYGRAPHCACHE_H_
+#define DEPENDENCYGRAPHCACHE_H_
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+
+#include "ControlDependencyGraph2.hpp"
+#include <string>
+
+namespace pdg
+{
+// On-disk cache of per-function CDGs. Every entry is a file in dir named after a
+// hash of the function name and body, so a function that did not change is not
+// rebuilt for another target or run. A node is stored as the index of its
+// instruction in the function, the function name is kept in the entry header and
+// checked on load. Only CDGs are cached: they depend on the body alone, while a
+// DDG also depends on the CFL summaries of the callees, which differ between the
+// programs a library function is linked into.
+// Loading and storing different functions from different threads is safe.
+class DependencyGraphCache
+{
+public:
+  explicit DependencyGraphCache(llvm::StringRef dir) : dir(dir.str()) {}
+
+  // hex MD5 of the name of F and of its instructions, operands and types, without
+  // metadata
+  static std::string hashFunction(const llvm::Function &F);
+
+  // nullptr when F has no valid entry
+  ControlDependencyGraph2 *loadCDG(llvm::Function &F, bool blockLevel);
+  bool storeCDG(ControlDependencyGraph2 &CDG);
+
+private:
+  std::string dir;
+
+  std::string getPath(const llvm::Function &F, llvm::StringRef kind) const;
+  bool load(llvm::Function &F, llvm::StringRef kind, DependencyGraph<InstructionWrapper> &G, FunctionInstMap &instMap);
+  bool store(llvm::Function &F, llvm::StringRef kind, DependencyGraph<InstructionWrapper> &G);
+};
+} // namespace pdg
+
+#endif
@@ -3,6 +3,7 @@
 #include "PDGExceptions.hpp"
 #include "PDGEnums.hpp"
 #include "InstructionWrapper.hpp"
+#include "llvm/ADT/SparseBitVector.h"
 #include <vector>
 
 namespace pdg
@@ -20,16 +21,21 @@ public:
   using const_iterator = DependencyLinkIterator<NodeT>;
 
   DependencyNode() = delete; 
-  DependencyNode(const NodeT *pData) : dataNode(pData) {}
+  DependencyNode(const NodeT *pData, unsigned id = 0) : dataNode(pData), id(id) {}
   void addDependencyTo(DependencyNode<NodeT> *pNode, DependencyType type);
   const NodeT *getData() const { return dataNode; }
+  // dense id of the node in its DependencyGraph
+  unsigned getId() const { return id; }
   DependencyLinkList &getDependencyList() { return dependencyList; }
   bool isDepends(const DependencyNode<NodeT> *dNode);
   DependencyType getDependencyType(const DependencyNode<NodeT> *dNode) const;
 
 private:
   const NodeT *dataNode;
+  unsigned id;
   DependencyLinkList dependencyList;
+  // ids of the nodes in dependencyList, so isDepends does not scan the list
+  llvm::SparseBitVector<> dependsOn;
 };
 
 template <class NodeT>
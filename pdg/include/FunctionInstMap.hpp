@@ -0,0 +1,57 @@
+#ifndef FUNCTIONINSTMAP_H_
+#define FUNCTIONINSTMAP_H_
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "InstructionWrapper.hpp"
+#include <deque>
+
+namespace pdg
+{
+// Instruction wrappers of a single function, owned by the graph that uses them.
+// Unlike the PDGUtils maps they are not shared, so graphs of different functions
+// can be built on different threads.
+class FunctionInstMap
+{
+public:
+  explicit FunctionInstMap(llvm::Function *Func) : Func(Func) {}
+  FunctionInstMap(const FunctionInstMap &) = delete;
+  FunctionInstMap &operator=(const FunctionInstMap &) = delete;
+
+  InstructionWrapper *getEntryW()
+  {
+    if (entryW == nullptr)
+    {
+      wrappers.emplace_back(Func, GraphNodeType::ENTRY);
+      entryW = &wrappers.back();
+    }
+    return entryW;
+  }
+
+  // the wrapper of inst, created on first use. nullptr stays nullptr
+  InstructionWrapper *get(llvm::Instruction *inst)
+  {
+    if (inst == nullptr)
+      return nullptr;
+    InstructionWrapper *&instW = instMap[inst];
+    if (instW == nullptr)
+    {
+      wrappers.emplace_back(inst, GraphNodeType::INST);
+      instW = &wrappers.back();
+    }
+    return instW;
+  }
+
+  InstructionWrapper *lookup(const llvm::Instruction *inst) const { return instMap.lookup(inst); }
+  llvm::Function *getFunction() const { return Func; }
+
+private:
+  llvm::Function *Func;
+  InstructionWrapper *entryW = nullptr;
+  // deque keeps the wrappers in place while it grows
+  std::deque<InstructionWrapper> wrappers;
+  llvm::DenseMap<const llvm::Instruction *, InstructionWrapper *> instMap;
+};
+} // namespace pdg
+
+#endif
@@ -4,8 +4,10 @@
 #include "llvm/IR/Module.h"
 #include "FunctionWrapper.hpp"
 #include "CallWrapper.hpp"
+#include "TypeTree.hpp"
 #include <set>
 #include <map>
+#include <memory>
 
 namespace pdg {
 class PDGUtils final
@@ -16,6 +18,10 @@ class PDGUtils final
     std::map<const llvm::Function *, std::set<InstructionWrapper *>> G_funcInstWMap;
     std::map<const llvm::Function *, FunctionWrapper *> G_funcMap;
     std::map<const llvm::CallInst *, CallWrapper *> G_callMap;
+    // functions whose instructions are already wrapped in G_instMap
+    std::set<const llvm::Function *> G_wrappedFuncs;
+    // parameter tree shapes, interned per (type, expand level)
+    std::map<std::pair<llvm::Type *, int>, std::unique_ptr<TypeTree>> G_typeTreeMap;
 
   public:
     PDGUtils() = default;
@@ -35,9 +41,12 @@ class PDGUtils final
     std::map<const llvm::Function *, std::set<InstructionWrapper *>> &getFuncInstWMap() { return G_funcInstWMap; }
     std::map<const llvm::Function *, FunctionWrapper *> &getFuncMap() { return G_funcMap; }
     std::map<const llvm::CallInst *, CallWrapper *> &getCallMap() { return G_callMap; }
+    const TypeTree &getTypeTree(llvm::Type *ty, int depth);
     void collectGlobalInsts(llvm::Module &M);
     void categorizeInstInFunc(llvm::Function &F);
+    static void categorizeInstInFunc(llvm::Function &F, FunctionWrapper &funcW);
     void constructInstMap(llvm::Function &F);
+    void constructFuncMap(llvm::Function &F);
     void constructFuncMap(llvm::Module &M);
 };
 } // namespace pdg
@@ -0,0 +1,39 @@
+#ifndef TYPETREE_H_
+#define TYPETREE_H_
+#include "llvm/IR/Type.h"
+#include <vector>
+
+namespace pdg
+{
+// Shape of a parameter tree: the types a value of a given type expands to, up to
+// a given depth. The shape only depends on the type, so it is built once per
+// (type, depth) and every formal and actual tree of that type is built from it.
+// The trees only hold the per-node wrappers.
+class TypeTree
+{
+public:
+  struct Node
+  {
+    llvm::Type *type;
+    llvm::Type *parentType;
+    int offset;
+    // index of the parent node, -1 for the root
+    int parent;
+    // a struct field, which may be accessed by a GEP, rather than a pointee
+    bool isField;
+  };
+
+  TypeTree(llvm::Type *rootTy, int depth);
+  // nodes in breadth first order, children of a node are contiguous and in order
+  const std::vector<Node> &getNodes() const { return nodes; }
+  unsigned size() const { return nodes.size(); }
+  static bool isFilePtrOrFuncTy(llvm::Type *ty);
+
+private:
+  std::vector<Node> nodes;
+
+  bool hasRecursiveType(unsigned idx) const;
+};
+} // namespace pdg
+
+#endif
@@ -31,9 +31,27 @@ tree<pdg::InstructionWrapper *> &pdg::ArgumentWrapper::getTree(TreeType treeTy)
   }
 }
 
-void pdg::ArgumentWrapper::copyTree(const tree<pdg::InstructionWrapper *> &srcTree, TreeType treeTy)
+void pdg::ArgumentWrapper::buildTree(const TypeTree &shape, TreeType treeTy, function_ref<InstructionWrapper *(const TypeTree::Node &)> makeNode)
 {
-  if (srcTree.empty())
+  tree<InstructionWrapper *> &paramTree = getTree(treeTy);
+  paramTree.clear();
+  // insert location of every node of shape, parents come before their children
+  std::vector<tree<InstructionWrapper *>::iterator> insertLocs;
+  insertLocs.reserve(shape.size());
+  for (const TypeTree::Node &node : shape.getNodes())
+  {
+    InstructionWrapper *treeTypeW = makeNode(node);
+    if (node.parent == -1)
+      insertLocs.push_back(paramTree.set_head(treeTypeW));
+    else
+      insertLocs.push_back(paramTree.append_child(insertLocs[node.parent], treeTypeW));
+  }
+  typeTree = &shape;
+}
+
+void pdg::ArgumentWrapper::copyTree(const ArgumentWrapper &srcArgW, TreeType treeTy)
+{
+  if (srcArgW.typeTree == nullptr)
   {
     errs() << arg->getParent()->getName() << " arg : " << *arg << " srcTree is empty!\n";
     return;
@@ -45,52 +63,31 @@ void pdg::ArgumentWrapper::copyTree(const tree<pdg::InstructionWrapper *> &srcTr
   Argument *newArg = nullptr;
   switch (treeTy)
   {
-  case TreeType::FORMAL_IN_TREE:
-    errs() << "FORMAL_IN_TREE can't be copied\n";
-    break;
   case TreeType::FORMAL_OUT_TREE:
-    formalOutTree = srcTree;
-    newArg =  ((TreeTypeWrapper*)(*srcTree.begin()))->getArgument();
+    newArg = srcArgW.arg;
     instWTy = GraphNodeType::FORMAL_OUT;
     break;
   case TreeType::ACTUAL_IN_TREE:
-    actualInTree = srcTree;
     newArg = this->getArg();
     instWTy = GraphNodeType::ACTUAL_IN;
     break;
   case TreeType::ACTUAL_OUT_TREE:
-    actualOutTree = srcTree;
     newArg = this->getArg();
     instWTy = GraphNodeType::ACTUAL_OUT;
     break;
+  default:
+    errs() << "FORMAL_IN_TREE can't be copied\n";
+    return;
   }
 
-  //    formalOutTree = formalInTree;
-  tree<InstructionWrapper *>::iterator SI = srcTree.begin();
-  tree<InstructionWrapper *>::iterator TI = getTree(treeTy).begin();
-  for (; SI != srcTree.end() && TI != getTree(treeTy).end(); ++SI, ++TI)
-  {
-    InstructionWrapper *treeTypeW;
-    InstructionWrapper *srcTreeW = (*SI);
-    if (SI == srcTree.begin())
-    {
-      treeTypeW = new TreeTypeWrapper(srcTreeW->getFunction(), instWTy,
-                                      newArg,
-                                      ((TreeTypeWrapper *)srcTreeW)->getTreeNodeType(),
-                                      ((TreeTypeWrapper *)srcTreeW)->getParentTreeNodeType(),
-                                      ((TreeTypeWrapper *)srcTreeW)->getNodeOffset());
-    }
-    else
-    {
-      treeTypeW = new TreeTypeWrapper(srcTreeW->getFunction(), GraphNodeType::PARAMETER_FIELD,
-                                      newArg,
-                                      ((TreeTypeWrapper *)srcTreeW)->getTreeNodeType(),
-                                      ((TreeTypeWrapper *)srcTreeW)->getParentTreeNodeType(),
-                                      ((TreeTypeWrapper *)srcTreeW)->getNodeOffset());
-    }
-    *TI = treeTypeW;
-    PDGUtils::getInstance().getFuncInstWMap()[srcTreeW->getFunction()].insert(treeTypeW);
-  }
+  // the nodes of the formal trees belong to the function of srcArgW
+  Function *srcFunc = srcArgW.arg->getParent();
+  buildTree(*srcArgW.typeTree, treeTy, [&](const TypeTree::Node &node) {
+    GraphNodeType nodeTy = node.parent == -1 ? instWTy : GraphNodeType::PARAMETER_FIELD;
+    InstructionWrapper *treeTypeW = new TreeTypeWrapper(srcFunc, nodeTy, newArg, node.type, node.parentType, node.offset);
+    PDGUtils::getInstance().getFuncInstWMap()[srcFunc].insert(treeTypeW);
+    return treeTypeW;
+  });
 }
 
 tree<pdg::InstructionWrapper *>::iterator pdg::ArgumentWrapper::tree_begin(TreeType treeTy)
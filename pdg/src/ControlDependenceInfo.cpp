@@ -0,0 +1,53 @@
+#include "ControlDependenceInfo.hpp"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/IR/CFG.h"
+
+using namespace llvm;
+
+pdg::ControlDependenceInfo::ControlDependenceInfo(Function &F, const PostDominatorTree &PDT)
+{
+  for (const DomTreeNode *node = PDT.getNode(&F.getEntryBlock()); node && node->getBlock(); node = node->getIDom())
+    entryDependents.push_back(node->getBlock());
+
+  // frontiers of the nodes whose parent is not visited yet. The root of a post
+  // dominator tree is virtual, it has no block and no frontier
+  DenseMap<const DomTreeNode *, SmallVector<BasicBlock *, 4>> frontiers;
+  for (const DomTreeNode *node : post_order(PDT.getRootNode()))
+  {
+    BasicBlock *X = node->getBlock();
+    if (X == nullptr)
+      continue;
+    SmallSetVector<BasicBlock *, 4> frontier;
+    // local: branches into X that X does not immediately postdominate
+    for (BasicBlock *Y : predecessors(X))
+    {
+      const DomTreeNode *YNode = PDT.getNode(Y);
+      if (YNode != nullptr && YNode->getIDom() != node)
+        frontier.insert(Y);
+    }
+    // up: the frontiers of the children that X does not immediately postdominate
+    for (const DomTreeNode *child : node->children())
+    {
+      auto it = frontiers.find(child);
+      if (it == frontiers.end())
+        continue;
+      for (BasicBlock *Y : it->second)
+        if (PDT.getNode(Y)->getIDom() != node)
+          frontier.insert(Y);
+      frontiers.erase(it);
+    }
+    for (BasicBlock *Y : frontier)
+      dependents[Y].push_back(X);
+    if (!frontier.empty())
+      frontiers[node].assign(frontier.begin(), frontier.end());
+  }
+}
+
+ArrayRef<BasicBlock *> pdg::ControlDependenceInfo::getDependents(const BasicBlock *BB) const
+{
+  auto it = dependents.find(BB);
+  if (it == dependents.end())
+    return {};
+  return it->second;
+}
@@ -1,4 +1,5 @@
 #include "ControlDependencyGraph.hpp"
+#include "ControlDependenceInfo.hpp"
 
 using namespace llvm;
 
@@ -52,7 +53,7 @@ void pdg::ControlDependencyGraph::addBBToBBDependency(BasicBlock *from, BasicBlo
 
 void pdg::ControlDependencyGraph::computeDependencies(Function &F)
 {
-  PDGUtils::getInstance().constructFuncMap(*F.getParent());
+  PDGUtils::getInstance().constructFuncMap(F);
   if (PDGUtils::getInstance().getFuncMap()[&F]->getEntryW() != nullptr)
   {
     return;
@@ -62,63 +63,13 @@ void pdg::ControlDependencyGraph::computeDependencies(Function &F)
   PDGUtils::getInstance().getFuncInstWMap()[&F].insert(entryW);
   PDGUtils::getInstance().getFuncMap()[&F]->setEntryW(entryW);
 
-  DomTreeNodeBase<BasicBlock> *node = PDT->getNode(&F.getEntryBlock());
-  while (node && node->getBlock()) {
-    // Walking the path backward and adding dependencies.
-    addInstToBBDependency(entryW, node->getBlock(), DependencyType::CONTROL);
-    node = node->getIDom();
-  }
-  std::vector<std::pair<BasicBlock *, BasicBlock *>> EdgeSet;
-
-  for (Function::iterator BI = F.begin(), E = F.end(); BI != E; ++BI)
-  {
-    BasicBlock *I = dyn_cast<BasicBlock>(BI);
-    for (succ_iterator SI = succ_begin(I), SE = succ_end(I); SI != SE; ++SI)
-    {
-      assert(I && *SI);
-      if (!PDT->dominates(*SI, I))
-      {
-        BasicBlock *B_second = dyn_cast<BasicBlock>(*SI);
-        EdgeSet.push_back(std::make_pair(I, B_second));
-      }
-    }
-  }
-
-  for (auto Edge : EdgeSet) {
-    BasicBlock *L = PDT->findNearestCommonDominator(Edge.first, Edge.second);
-
-    // capture loop dependence
-    if (L == Edge.first)
-    {
-      addBBToBBDependency(Edge.first, L, DependencyType::CONTROL);
-    }
-    DomTreeNode *domNode = PDT->getNode(Edge.second);
-    if (domNode == nullptr)
-    {
-      continue;
-    }
-    while (domNode->getBlock() != L)
-    {
-      addBBToBBDependency(Edge.first, domNode->getBlock(), DependencyType::CONTROL);
-      domNode = domNode->getIDom();
-    }
-  }
-
-  EdgeSet.clear();
-  for (Function::iterator FI = F.begin(), E = F.end(); FI != E; ++FI)
+  ControlDependenceInfo CDI(F, *PDT);
+  for (BasicBlock *BB : CDI.getEntryDependents())
+    addInstToBBDependency(entryW, BB, DependencyType::CONTROL);
+  for (BasicBlock &BB : F)
   {
-    // Zhiyuan comment: find adjacent BasicBlock pairs in CFG, but the predecessor
-    //does not dominate successor.
-    BasicBlock *I = dyn_cast<BasicBlock>(FI);
-    for (succ_iterator SI = succ_begin(I), SE = succ_end(I); SI != SE; ++SI)
-    {
-      assert(I && *SI);
-      if (!PDT->dominates(*SI, I))
-      {
-        BasicBlock *B_second = dyn_cast<BasicBlock>(*SI);
-        EdgeSet.push_back(std::make_pair(I, B_second));
-      }
-    }
+    for (BasicBlock *dependent : CDI.getDependents(&BB))
+      addBBToBBDependency(&BB, dependent, DependencyType::CONTROL);
   }
 }
 
@@ -1,14 +1,20 @@
 #include "ControlDependencyGraph2.hpp"
+#include "ControlDependenceInfo.hpp"
 
 using namespace llvm;
 
 void pdg::ControlDependencyGraph2::addInstToBBDependency(InstructionWrapper *from, BasicBlock *to, DependencyType depType)
 {
+  if (blockLevel)
+  {
+    CDG->addDependency(from, instMap.get(to->getTerminator()), depType);
+    return;
+  }
   for (BasicBlock::iterator ii = to->begin(), ie = to->end(); ii != ie; ++ii)
   {
     if (Instruction *Ins = dyn_cast<Instruction>(ii))
     {
-      InstructionWrapper *iw = PDGUtils::getInstance().getInstMap()[Ins];
+      InstructionWrapper *iw = instMap.get(Ins);
       CDG->addDependency(from, iw, depType);
     }
   }
@@ -17,14 +23,21 @@ void pdg::ControlDependencyGraph2::addInstToBBDependency(InstructionWrapper *fro
 void pdg::ControlDependencyGraph2::addBBToBBDependency(BasicBlock *from, BasicBlock *to, DependencyType type)
 {
   Instruction *Ins = from->getTerminator();
-  InstructionWrapper *iw = PDGUtils::getInstance().getInstMap()[Ins];
+  InstructionWrapper *iw = instMap.get(Ins);
+  if (blockLevel)
+  {
+    // self loop在block粒度下没有意义
+    if (from != to)
+      CDG->addDependency(iw, instMap.get(to->getTerminator()), type);
+    return;
+  }
   // self loop
   if (from == to)
   {
     for (BasicBlock::iterator ii = from->begin(), ie = from->end(); ii != ie; ++ii)
     {
       Instruction *inst = dyn_cast<Instruction>(ii);
-      InstructionWrapper *iwTo = PDGUtils::getInstance().getInstMap()[inst];
+      InstructionWrapper *iwTo = instMap.get(inst);
       CDG->addDependency(iw, iwTo, type);
     }
   }
@@ -33,7 +46,7 @@ void pdg::ControlDependencyGraph2::addBBToBBDependency(BasicBlock *from, BasicBl
     for (BasicBlock::iterator ii = to->begin(), ie = to->end(); ii != ie; ++ii)
     {
       Instruction *inst = dyn_cast<Instruction>(ii);
-      InstructionWrapper *iwTo = PDGUtils::getInstance().getInstMap()[inst];
+      InstructionWrapper *iwTo = instMap.get(inst);
       CDG->addDependency(iw, iwTo, type);
     }
   }
@@ -41,131 +54,154 @@ void pdg::ControlDependencyGraph2::addBBToBBDependency(BasicBlock *from, BasicBl
 
 void pdg::ControlDependencyGraph2::computeDependencies(Function &F)
 {
-  PDGUtils::getInstance().constructFuncMap(*F.getParent());
-  if (PDGUtils::getInstance().getFuncMap()[&F]->getEntryW() != nullptr)
+  InstructionWrapper *entryW = instMap.getEntryW();
+  // 由postdominance frontier一次得到所有block间的控制依赖，不再对每条CFG边遍历PDT
+  ControlDependenceInfo CDI(F, *PDT);
+  for (BasicBlock *BB : CDI.getEntryDependents())
+    addInstToBBDependency(entryW, BB, DependencyType::CONTROL);
+  for (BasicBlock &BB : F)
   {
-    return;
+    for (BasicBlock *dependent : CDI.getDependents(&BB))
+      addBBToBBDependency(&BB, dependent, DependencyType::CONTROL);
   }
+}
 
-  InstructionWrapper *entryW = new InstructionWrapper(&F, GraphNodeType::ENTRY);
-  PDGUtils::getInstance().getFuncInstWMap()[&F].insert(entryW);
-  PDGUtils::getInstance().getFuncMap()[&F]->setEntryW(entryW);
-
-  DomTreeNodeBase<BasicBlock> *node = PDT->getNode(&F.getEntryBlock());
-  while (node && node->getBlock())
-  {
-    // Walking the path backward and adding dependencies.
-    addInstToBBDependency(entryW, node->getBlock(), DependencyType::CONTROL);
-    node = node->getIDom();
-  }
-  std::vector<std::pair<BasicBlock *, BasicBlock *>> EdgeSet;
+pdg::ControlDependencyGraph2::cgdNode *pdg::ControlDependencyGraph2::getEntry()
+{
+  if (CDG->begin_child() == CDG->end_child())
+    return nullptr;
+  return *CDG->begin_child();
+}
 
-  for (Function::iterator BI = F.begin(), E = F.end(); BI != E; ++BI)
+// 边权均为1，BFS即可得到最短路，不经过banned中的node和边。到达dst后提前结束
+bool pdg::ControlDependencyGraph2::bfs(cgdNode *src, cgdNode *dst, PathTree &tree,
+                                       const std::set<cgdNode *> &bannedNodes,
+                                       const std::set<std::pair<cgdNode *, cgdNode *>> &bannedEdges)
+{
+  std::vector<cgdNode *> queue{src};
+  tree.pre[src] = nullptr;
+  tree.dis[src] = 0;
+  for (size_t head = 0; head < queue.size(); head++)
   {
-    // Zhiyuan comment: find adjacent BasicBlock pairs in CFG, but the predecessor
-    // does not dominate successor.
-    BasicBlock *I = dyn_cast<BasicBlock>(BI);
-    for (succ_iterator SI = succ_begin(I), SE = succ_end(I); SI != SE; ++SI)
+    cgdNode *node = queue[head];
+    if (node == dst)
+      return true;
+    for (std::pair<cgdNode *, pdg::DependencyType> &child : node->getDependencyList())
     {
-      assert(I && *SI);
-      if (!PDT->dominates(*SI, I))
-      {
-        BasicBlock *B_second = dyn_cast<BasicBlock>(*SI);
-        EdgeSet.push_back(std::make_pair(I, B_second));
-      }
+      cgdNode *next = child.first;
+      if (tree.dis.count(next) || bannedNodes.count(next) || bannedEdges.count({node, next}))
+        continue;
+      tree.pre[next] = node;
+      tree.dis[next] = tree.dis[node] + 1;
+      queue.push_back(next);
     }
   }
+  return false;
+}
 
-  for (auto Edge : EdgeSet)
-  {
-    BasicBlock *L = PDT->findNearestCommonDominator(Edge.first, Edge.second);
-
-    // capture loop dependence
-    if (L == Edge.first)
-    {
-      addBBToBBDependency(Edge.first, L, DependencyType::CONTROL);
-    }
-    DomTreeNode *domNode = PDT->getNode(Edge.second);
-    if (domNode == nullptr)
-    {
-      continue;
-    }
-    while (domNode->getBlock() != L)
-    {
-      addBBToBBDependency(Edge.first, domNode->getBlock(), DependencyType::CONTROL);
-      domNode = domNode->getIDom();
-    }
-  }
+const pdg::ControlDependencyGraph2::PathTree &pdg::ControlDependencyGraph2::getPathTree(cgdNode *src)
+{
+  auto it = pathTrees.find(src);
+  if (it != pathTrees.end())
+    return it->second;
+  PathTree &tree = pathTrees[src];
+  bfs(src, nullptr, tree, {}, {});
+  return tree;
 }
 
-void pdg::ControlDependencyGraph2::initDijkstra()
+// 沿pre得到从树根到dst的node序列，dst不可达时为空
+std::vector<pdg::ControlDependencyGraph2::cgdNode *> pdg::ControlDependencyGraph2::treePath(const PathTree &tree, cgdNode *dst)
 {
-  std::set<cgdNode *> unfinish;
+  std::vector<cgdNode *> nodes;
+  if (!tree.pre.count(dst))
+    return nodes;
+  for (cgdNode *node = dst; node != nullptr; node = tree.pre.at(node))
+    nodes.push_back(node);
+  std::reverse(nodes.begin(), nodes.end());
+  return nodes;
+}
 
-  // 初始化数组
-  cgdNode *entry = *CDG->begin_child();
-  for (cgdNode *node : CDG->getNodeSet())
+// 去掉末尾的目标node与没有对应指令的入口node
+void pdg::ControlDependencyGraph2::toInstPath(const std::vector<cgdNode *> &nodes, std::vector<llvm::Instruction *> &path)
+{
+  for (size_t i = 0; i + 1 < nodes.size(); i++)
   {
-    if (node == entry)
-    {
-      dis[node] = 0;
-      pre[node] = nullptr;
-    }
-    else if (entry->isDepends(node))
-    {
-      dis[node] = 1;
-      pre[node] = entry;
-    }
-    else
-    {
-      dis[node] = UINT64_MAX;
-      pre[node] = nullptr;
-    }
-    unfinish.insert(node);
+    Instruction *ins = nodes[i]->getData()->getInstruction();
+    if (ins != nullptr)
+      path.push_back(ins);
   }
-  unfinish.erase(entry);
+}
 
-  while (!unfinish.empty())
-  {
-    cgdNode *next = *unfinish.begin();
-    for (cgdNode *node : unfinish)
-    {
-      if (dis[node] < dis[next])
-      {
-        next = node;
-      }
-    }
+pdg::ControlDependencyGraph2::cgdNode *pdg::ControlDependencyGraph2::getNodeForInst(llvm::Instruction *ins)
+{
+  if (blockLevel)
+    ins = ins->getParent()->getTerminator();
+  return CDG->getNodeByData(instMap.get(ins));
+}
 
-    for (std::pair<cgdNode *, pdg::DependencyType> &child : next->getDependencyList())
-    {
-      if (dis[next] + 1 < dis[child.first])
-      {
-        dis[child.first] = dis[next] + 1;
-        pre[child.first] = next;
-      }
-    }
-    unfinish.erase(next);
+void pdg::ControlDependencyGraph2::getRDep(llvm::Instruction *ins, std::vector<std::vector<llvm::Instruction *>> &pathVector)
+{
+  std::vector<llvm::Instruction *> path;
+  cgdNode *entry = getEntry();
+  if (entry != nullptr)
+  {
+    cgdNode *dst = getNodeForInst(ins);
+    toInstPath(treePath(getPathTree(entry), dst), path);
   }
+  pathVector.push_back(std::move(path));
 }
 
-void pdg::ControlDependencyGraph2::getRDep(llvm::Instruction *ins, std::vector<std::vector<llvm::Instruction *>> &pathVector)
+void pdg::ControlDependencyGraph2::getKRDep(llvm::Instruction *ins, unsigned k, std::vector<std::vector<llvm::Instruction *>> &pathVector)
 {
-  if(Func->getName()=="krb5_ldap_lockout_audit")
+  cgdNode *entry = getEntry();
+  if (entry == nullptr || k == 0)
+    return;
+  cgdNode *dst = getNodeForInst(ins);
+
+  std::vector<std::vector<cgdNode *>> found, candidates;
+  found.push_back(treePath(getPathTree(entry), dst));
+  if (found.back().empty())
+    return;
+
+  while (found.size() < k)
   {
-    this->dump("krb5.dot");
+    // 依次以上一条path中的每个node为分叉点，禁止已找到的path在该点之后的边
+    std::vector<cgdNode *> last = found.back();
+    for (size_t i = 0; i + 1 < last.size(); i++)
+    {
+      cgdNode *spur = last[i];
+      std::set<cgdNode *> bannedNodes(last.begin(), last.begin() + i);
+      std::set<std::pair<cgdNode *, cgdNode *>> bannedEdges;
+      for (std::vector<cgdNode *> &p : found)
+        if (p.size() > i + 1 && std::equal(last.begin(), last.begin() + i + 1, p.begin()))
+          bannedEdges.insert({p[i], p[i + 1]});
+
+      PathTree tree;
+      if (!bfs(spur, dst, tree, bannedNodes, bannedEdges))
+        continue;
+      std::vector<cgdNode *> candidate(last.begin(), last.begin() + i);
+      std::vector<cgdNode *> spurPath = treePath(tree, dst);
+      candidate.insert(candidate.end(), spurPath.begin(), spurPath.end());
+      if (std::find(candidates.begin(), candidates.end(), candidate) == candidates.end() &&
+          std::find(found.begin(), found.end(), candidate) == found.end())
+        candidates.push_back(std::move(candidate));
+    }
+    if (candidates.empty())
+      break;
+
+    auto shortest = std::min_element(candidates.begin(), candidates.end(),
+                                     [](const std::vector<cgdNode *> &a, const std::vector<cgdNode *> &b)
+                                     { return a.size() < b.size(); });
+    found.push_back(std::move(*shortest));
+    candidates.erase(shortest);
   }
 
-  std::vector<llvm::Instruction *> path;
-  cgdNode *dst = CDG->getNodeByData(PDGUtils::getInstance().getInstMap()[ins]);
-  cgdNode *pre = this->pre[dst];
-  while (pre!=nullptr)
+  for (std::vector<cgdNode *> &nodes : found)
   {
-    Instruction *ins = pre->getData()->getInstruction();
-    if (ins != nullptr)
-      path.insert(path.begin(),ins);
-    pre = this->pre[pre];
+    std::vector<llvm::Instruction *> path;
+    toInstPath(nodes, path);
+    pathVector.push_back(std::move(path));
   }
-  pathVector.push_back(std::move(path));
 }
 
 /* void pdg::ControlDependencyGraph2::getRDep(llvm::Instruction *ins, std::vector<std::vector<llvm::Instruction *>> &pathVector)
@@ -240,8 +276,8 @@ namespace llvm
   {
     static NodeRef getEntryNode(pdg::DependencyGraph<InstructionWrapper> *N) { return *(N->getNodeSet().begin()); }
     using nodes_iterator = DependencyGraph<InstructionWrapper>::nodes_iterator;
-    static nodes_iterator nodes_begin(pdg::DependencyGraph<InstructionWrapper> *N) { return nodes_iterator(N->getNodeSet().begin()); }
-    static nodes_iterator nodes_end(pdg::DependencyGraph<InstructionWrapper> *N) { return nodes_iterator(N->getNodeSet().end()); }
+    static nodes_iterator nodes_begin(pdg::DependencyGraph<InstructionWrapper> *N) { return N->begin_child(); }
+    static nodes_iterator nodes_end(pdg::DependencyGraph<InstructionWrapper> *N) { return N->end_child(); }
   };
 
   template <>
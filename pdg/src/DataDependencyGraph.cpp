@@ -22,6 +22,49 @@ void pdg::DataDependencyGraph::constructFuncMapAndCreateFunctionEntry()
   }
 }
 
+// bucket of a memory operation: its underlying object when that is an identified
+// object (alloca, global, noalias call or argument), nullptr when it is unknown
+static const Value *getAliasBucket(const Value *ptr)
+{
+  const Value *obj = getUnderlyingObject(ptr);
+  return isIdentifiedObject(obj) ? obj : nullptr;
+}
+
+// distinct identified objects never alias, so an operation in a known bucket only
+// needs to be queried against its own bucket and the unknown one. The candidates
+// are visited in place, without copying the buckets
+template <typename T, typename Fn>
+static void forEachAliasCandidate(const Value *bucket, const std::vector<T *> &all,
+                                  const MapVector<const Value *, std::vector<T *>> &buckets, Fn visit)
+{
+  if (bucket == nullptr)
+  {
+    for (T *op : all)
+      visit(op);
+    return;
+  }
+  auto known = buckets.find(bucket);
+  if (known != buckets.end())
+    for (T *op : known->second)
+      visit(op);
+  auto unknown = buckets.find(nullptr);
+  if (unknown != buckets.end())
+    for (T *op : unknown->second)
+      visit(op);
+}
+
+const MapVector<const Value *, std::vector<StoreInst *>> &pdg::DataDependencyGraph::getStoreBuckets()
+{
+  if (storeBucketsFunc != Func)
+  {
+    storeBuckets.clear();
+    for (StoreInst *si : funcW->getStoreInstList())
+      storeBuckets[getAliasBucket(si->getPointerOperand())].push_back(si);
+    storeBucketsFunc = Func;
+  }
+  return storeBuckets;
+}
+
 void pdg::DataDependencyGraph::collectDataDependencyInFunc()
 {
   for (inst_iterator instIt = inst_begin(Func); instIt != inst_end(Func); ++instIt)
@@ -42,81 +85,55 @@ void pdg::DataDependencyGraph::collectDataDependencyInFunc()
 
 void pdg::DataDependencyGraph::collectAliasDependencies()
 {
-  auto &pdgUtils = PDGUtils::getInstance();
-  auto funcMap = pdgUtils.getFuncMap()[Func];
-  auto instMap = pdgUtils.getInstMap();
-  auto storeVec = funcMap->getStoreInstList();
-  auto loadVec = funcMap->getLoadInstList();
-  auto castVec = funcMap->getCastInstList();
+  auto &storeVec = funcW->getStoreInstList();
+  auto &loadVec = funcW->getLoadInstList();
+  auto &castVec = funcW->getCastInstList();
+
+  MapVector<const Value *, std::vector<LoadInst *>> loadBuckets;
+  for (LoadInst *li : loadVec)
+    loadBuckets[getAliasBucket(li->getPointerOperand())].push_back(li);
 
+  auto &storeBuckets = getStoreBuckets();
   for (StoreInst *si : storeVec)
   {
+    const Value *bucket = getAliasBucket(si->getPointerOperand());
     MemoryLocation s_loc = MemoryLocation::get(si);
-    for (LoadInst *li : loadVec)
+    forEachAliasCandidate(bucket, loadVec, loadBuckets, [&](LoadInst *li)
     {
       MemoryLocation l_loc = MemoryLocation::get(li);
       AliasResult andersAAResult = andersAA->query(s_loc, l_loc);
       // AliasResult steensAAResult = steenAA->alias(s_loc, l_loc);
       if (andersAAResult != AliasResult::NoAlias)
       {
-        InstructionWrapper *loadInstW = instMap[li];
-        InstructionWrapper *storeInstW = instMap[si];
+        InstructionWrapper *loadInstW = getInstW(li);
+        InstructionWrapper *storeInstW = getInstW(si);
         DDG->addDependency(storeInstW, loadInstW, DependencyType::DATA_ALIAS);
         DDG->addDependency(loadInstW, storeInstW, DependencyType::DATA_ALIAS);
       }
-    }
-    
-    for (StoreInst *si1 : storeVec) {
+    });
+
+    forEachAliasCandidate(bucket, storeVec, storeBuckets, [&](StoreInst *si1)
+    {
       if (si == si1)
-        continue;
+        return;
       MemoryLocation s1_loc = MemoryLocation::get(si1);
       AliasResult andersAAResult = andersAA->query(s_loc, s1_loc);
       if (andersAAResult != AliasResult::NoAlias) {
-        InstructionWrapper *store1InstW = PDGUtils::getInstance().getInstMap()[si];
-        InstructionWrapper *store2InstW = PDGUtils::getInstance().getInstMap()[si1];
+        InstructionWrapper *store1InstW = getInstW(si);
+        InstructionWrapper *store2InstW = getInstW(si1);
         DDG->addDependency(store1InstW, store2InstW, DependencyType::DATA_ALIAS);
         DDG->addDependency(store2InstW, store1InstW, DependencyType::DATA_ALIAS);
       }
-    }
-  }
-
-  // add alias info for two load instructions
-  for (LoadInst *li1 : loadVec)
-  {
-    for (LoadInst *li2 : loadVec)
-    {
-      if (li1 == li2)
-      {
-        continue;
-      }
-      MemoryLocation li1_loc = MemoryLocation::get(li1);
-      MemoryLocation li2_loc = MemoryLocation::get(li2);
-
-      Type *li1LocTy = li1->getPointerOperandType();
-      Type *li2LocTy = li2->getPointerOperandType();
-
-      if (li1 != li2)
-      {
-        continue;
-      }
-      AliasResult AA_result = andersAA->query(li1_loc, li2_loc);
-      if (AA_result != AliasResult::NoAlias)
-      {
-        InstructionWrapper *loadInstW1 = instMap[li1];
-        InstructionWrapper *loadInstW2 = instMap[li2];
-        DDG->addDependency(loadInstW1, loadInstW2, DependencyType::DATA_ALIAS);
-      }
-    }
+    });
   }
 
   for (CastInst *csi : castVec)
   {
-    errs() << *csi << "\n";
     auto srcInst = dyn_cast<Instruction>(csi->getOperand(0));
     auto destInst = csi;
 
-    InstructionWrapper *srcInstW = instMap[srcInst];
-    InstructionWrapper *destInstW = instMap[destInst];
+    InstructionWrapper *srcInstW = getInstW(srcInst);
+    InstructionWrapper *destInstW = getInstW(destInst);
     DDG->addDependency(srcInstW, destInstW, DependencyType::DATA_ALIAS);
     DDG->addDependency(destInstW, srcInstW, DependencyType::DATA_ALIAS);
   }
@@ -128,8 +145,8 @@ void pdg::DataDependencyGraph::collectReadFromDependency(llvm::Instruction *inst
   {
     if (Instruction *pInst = dyn_cast<Instruction>(li->getPointerOperand()))
     {
-      DDG->addDependency(PDGUtils::getInstance().getInstMap()[pInst],
-                         PDGUtils::getInstance().getInstMap()[inst],
+      DDG->addDependency(getInstW(pInst),
+                         getInstW(inst),
                          DependencyType::DATA_READ);
     }
   }
@@ -144,8 +161,8 @@ void pdg::DataDependencyGraph::collectDefUseDependency(llvm::Instruction *inst)
     if (Instruction *pInst = dyn_cast<Instruction>(*cuit))
     {
       // add info flow from the instruction to current instruction
-      DDG->addDependency(PDGUtils::getInstance().getInstMap()[pInst],
-                         PDGUtils::getInstance().getInstMap()[inst],
+      DDG->addDependency(getInstW(pInst),
+                         getInstW(inst),
                          DependencyType::DATA_DEF_USE);
     }
   }
@@ -165,8 +182,8 @@ void pdg::DataDependencyGraph::collectCallInstDependency(llvm::Instruction *inst
         // DDG->addDependency(PDGUtils::getInstance().getInstMap()[tmpInst],
         //                    PDGUtils::getInstance().getInstMap()[inst],
         //                    DependencyType::DATA_CALL_PARA);
-        DDG->addDependency(PDGUtils::getInstance().getInstMap()[inst],
-                           PDGUtils::getInstance().getInstMap()[tmpInst],
+        DDG->addDependency(getInstW(inst),
+                           getInstW(tmpInst),
                            DependencyType::DATA_CALL_PARA);
       }
     }
@@ -176,11 +193,11 @@ void pdg::DataDependencyGraph::collectCallInstDependency(llvm::Instruction *inst
 std::vector<Instruction *> pdg::DataDependencyGraph::getRAWDepList(Instruction *pLoadInst)
 {
   std::vector<Instruction *> _flowdep_set;
-  std::vector<StoreInst *> StoreVec = PDGUtils::getInstance().getFuncMap()[Func]->getStoreInstList();
+  std::vector<StoreInst *> &StoreVec = funcW->getStoreInstList();
   // for each Load Instruction, find related Store Instructions(alias considered)
   LoadInst *LI = dyn_cast<LoadInst>(pLoadInst);
   MemoryLocation LI_Loc = MemoryLocation::get(LI);
-  for (StoreInst *SI : StoreVec)
+  forEachAliasCandidate(getAliasBucket(LI->getPointerOperand()), StoreVec, getStoreBuckets(), [&](StoreInst *SI)
   {
     MemoryLocation SI_Loc = MemoryLocation::get(SI);
     AliasResult andersAAResult = andersAA->query(LI_Loc, SI_Loc);
@@ -189,7 +206,7 @@ std::vector<Instruction *> pdg::DataDependencyGraph::getRAWDepList(Instruction *
     {
       _flowdep_set.push_back(SI);
     }
-  }
+  });
   return _flowdep_set;
 }
 
@@ -200,8 +217,8 @@ void pdg::DataDependencyGraph::collectRAWDependency(llvm::Instruction *inst)
 
   for (unsigned i = 0; i < flowdep_set.size(); i++)
   {
-    DDG->addDependency(PDGUtils::getInstance().getInstMap()[flowdep_set[i]],
-                       PDGUtils::getInstance().getInstMap()[inst],
+    DDG->addDependency(getInstW(flowdep_set[i]),
+                       getInstW(inst),
                        DependencyType::DATA_RAW);
   }
 
@@ -218,8 +235,8 @@ void pdg::DataDependencyGraph::collectNonLocalDependency(llvm::Instruction *inst
   for (NonLocalDepResult &I : result)
   {
     const MemDepResult &nonLocal_res = I.getResult();
-    InstructionWrapper *itInst = PDGUtils::getInstance().getInstMap()[inst];
-    InstructionWrapper *parentInst = PDGUtils::getInstance().getInstMap()[nonLocal_res.getInst()];
+    InstructionWrapper *itInst = getInstW(inst);
+    InstructionWrapper *parentInst = getInstW(nonLocal_res.getInst());
 
     if (nonLocal_res.getInst() != nullptr)
     {
@@ -231,18 +248,27 @@ void pdg::DataDependencyGraph::collectNonLocalDependency(llvm::Instruction *inst
 
 pdg::DependencyNode<pdg::InstructionWrapper> *pdg::DataDependencyGraph::getNodeByData(Instruction *inst)
 {
-  return DDG->getNodeByData(PDGUtils::getInstance().getInstMap()[inst]);
+  return DDG->getNodeByData(getInstW(inst));
 }
 
 typename pdg::DependencyNode<pdg::InstructionWrapper>::DependencyLinkList pdg::DataDependencyGraph::getNodeDepList(Instruction *inst)
 {
-  return DDG->getNodeDepList(PDGUtils::getInstance().getInstMap()[inst]);
+  return DDG->getNodeDepList(getInstW(inst));
+}
+
+pdg::InstructionWrapper *pdg::DataDependencyGraph::getInstW(Instruction *inst)
+{
+  if (localInsts)
+    return localInsts->get(inst);
+  return PDGUtils::getInstance().getInstMap()[inst];
 }
 
 bool pdg::DataDependencyGraph::runOnFunction(Function &F)
 {
   Func = &F;
-  PDGUtils::getInstance().constructFuncMap(*F.getParent());
+  storeBucketsFunc = nullptr;
+  PDGUtils::getInstance().constructFuncMap(F);
+  funcW = PDGUtils::getInstance().getFuncMap()[&F];
   initializeMemoryDependencyPasses();
   constructFuncMapAndCreateFunctionEntry();
   collectDataDependencyInFunc();
@@ -250,6 +276,26 @@ bool pdg::DataDependencyGraph::runOnFunction(Function &F)
   return false;
 }
 
+void pdg::DataDependencyGraph::buildLocal(Function &F, CFLAndersAAResult &andersAA,
+                                          CFLSteensAAResult &steenAA, MemoryDependenceResults &MD)
+{
+  Func = &F;
+  storeBucketsFunc = nullptr;
+  localInsts.reset(new FunctionInstMap(&F));
+  localFuncW.reset(new FunctionWrapper(&F));
+  funcW = localFuncW.get();
+  PDGUtils::categorizeInstInFunc(F, *funcW);
+  funcW->setEntryW(localInsts->getEntryW());
+  this->andersAA = &andersAA;
+  this->steenAA = &steenAA;
+  this->MD = &MD;
+  collectDataDependencyInFunc();
+  collectAliasDependencies();
+  this->andersAA = nullptr;
+  this->steenAA = nullptr;
+  this->MD = nullptr;
+}
+
 void pdg::DataDependencyGraph::getAnalysisUsage(AnalysisUsage &AU) const
 {
   AU.addRequired<MemoryDependenceWrapperPass>();
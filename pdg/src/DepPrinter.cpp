@@ -24,8 +24,8 @@ struct GraphTraits<pdg::DependencyGraph<pdg::InstructionWrapper> *> : public Gra
 {
   static NodeRef getEntryNode(pdg::DependencyGraph<InstructionWrapper> *N) { return *(N->getNodeSet().begin()); }
   using nodes_iterator = DependencyGraph<InstructionWrapper>::nodes_iterator;
-  static nodes_iterator nodes_begin(pdg::DependencyGraph<InstructionWrapper> *N) { return nodes_iterator(N->getNodeSet().begin()); }
-  static nodes_iterator nodes_end(pdg::DependencyGraph<InstructionWrapper> *N) { return nodes_iterator(N->getNodeSet().end()); }
+  static nodes_iterator nodes_begin(pdg::DependencyGraph<InstructionWrapper> *N) { return N->begin_child(); }
+  static nodes_iterator nodes_end(pdg::DependencyGraph<InstructionWrapper> *N) { return N->end_child(); }
 };
 
 // DDG 
@@ -1,4 +1,3 @@
-
 using namespace pdg;
 
 template <typename NodeT>
@@ -6,13 +5,15 @@ DependencyGraph<NodeT>::~DependencyGraph()
 {
   nodeSet.clear();
   DataToNodeMap.clear();
+  nodeArena.DestroyAll();
 }
 
 template <typename NodeT>
 void DependencyGraph<NodeT>::addNode(const NodeT *dNode)
 {
-  DataToNodeMap[dNode] = new DependencyNode<NodeT>(dNode);
-  nodeSet.push_back(DataToNodeMap[dNode]);
+  unsigned id = nodeSet.size();
+  DataToNodeMap[dNode] = id;
+  nodeSet.push_back(new (nodeArena.Allocate()) DependencyNode<NodeT>(dNode, id));
 }
 
 template <typename NodeT>
@@ -22,9 +23,19 @@ DependencyNode<NodeT> *DependencyGraph<NodeT>::getNodeByData(const NodeT *data)
   if (it == DataToNodeMap.end())
   {
     addNode(data);
+    return nodeSet.back();
   }
 
-  return DataToNodeMap[data];
+  return nodeSet[it->second];
+}
+
+template <typename NodeT>
+DependencyNode<NodeT> *DependencyGraph<NodeT>::lookupNode(const NodeT *data) const
+{
+  auto it = DataToNodeMap.find(data);
+  if (it == DataToNodeMap.end())
+    return nullptr;
+  return nodeSet[it->second];
 }
 
 template <typename NodeT>
@@ -46,28 +57,19 @@ void DependencyGraph<NodeT>::addDependency(const NodeT *from, const NodeT *to, D
 template <typename NodeT>
 bool DependencyGraph<NodeT>::isDepends(const NodeT *data1, const NodeT *data2)
 {
-  bool hasDepends = false;
-  try
-  {
-    hasDepends = DataToNodeMap[data1]->isDepends(DataToNodeMap[data2]);
-  }
-  catch (std::exception &e)
-  {
-    llvm::errs() << e.what() << "\n";
-  }
-  return hasDepends;
+  DependencyNode<NodeT> *node1 = lookupNode(data1);
+  DependencyNode<NodeT> *node2 = lookupNode(data2);
+  if (node1 == nullptr || node2 == nullptr)
+    return false;
+  return node1->isDepends(node2);
 }
 
 template <typename NodeT>
 DependencyType DependencyGraph<NodeT>::getDepType(const NodeT *data1, const NodeT *data2)
 {
-  try
-  {
-    DependencyType depType = DataToNodeMap[data1]->getDependencyType(DataToNodeMap[data2]);
-    return depType;
-  }
-  catch (std::exception &e)
-  {
-    llvm::errs() << e.what() << "\n";
-  }
+  DependencyNode<NodeT> *node1 = lookupNode(data1);
+  DependencyNode<NodeT> *node2 = lookupNode(data2);
+  if (node1 == nullptr || node2 == nullptr)
+    return DependencyType::NO_DEPENDENCY;
+  return node1->getDependencyType(node2);
 }
\ No newline at end of file
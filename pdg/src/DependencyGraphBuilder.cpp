@@ -0,0 +1,93 @@
+#include "DependencyGraphBuilder.hpp"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/PhiValues.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/Support/ThreadPool.h"
+#include <map>
+
+using namespace llvm;
+
+// default of -memdep-block-scan-limit, as used by MemoryDependenceWrapperPass
+static const unsigned MemDepBlockScanLimit = 100;
+
+namespace
+{
+// TargetLibraryInfo of every function, shared by the CFL analyses like in the pass manager
+class TLICache
+{
+public:
+  const TargetLibraryInfo &get(Function &F)
+  {
+    auto it = TLIs.find(&F);
+    if (it != TLIs.end())
+      return it->second;
+    std::unique_ptr<TargetLibraryInfoImpl> &TLII = impls[F.getParent()];
+    if (!TLII)
+      TLII.reset(new TargetLibraryInfoImpl(Triple(F.getParent()->getTargetTriple())));
+    return TLIs.emplace(&F, TargetLibraryInfo(*TLII, &F)).first->second;
+  }
+
+private:
+  std::map<const Module *, std::unique_ptr<TargetLibraryInfoImpl>> impls;
+  std::map<const Function *, TargetLibraryInfo> TLIs;
+};
+} // namespace
+
+std::vector<pdg::FunctionDependencies> pdg::buildDependencyGraphs(ArrayRef<Function *> funcs, bool withDDG, unsigned threads,
+                                                                  DependencyGraphCache *cache)
+{
+  std::vector<FunctionDependencies> result(funcs.size());
+  {
+    // every task only touches its own function and its own result
+    ThreadPool pool(hardware_concurrency(threads));
+    for (size_t i = 0; i < funcs.size(); i++)
+    {
+      result[i].func = funcs[i];
+      if (funcs[i]->isDeclaration())
+        continue;
+      pool.async([&result, i, cache]
+                 {
+        FunctionDependencies &deps = result[i];
+        if (cache != nullptr)
+          deps.CDG.reset(cache->loadCDG(*deps.func, true));
+        if (deps.CDG)
+          return;
+        deps.PDT.reset(new PostDominatorTree(*deps.func));
+        deps.CDG.reset(new ControlDependencyGraph2(deps.func, deps.PDT.get()));
+        if (cache != nullptr)
+          cache->storeCDG(*deps.CDG); });
+    }
+    pool.wait();
+  }
+
+  if (!withDDG)
+    return result;
+
+  TLICache TLIs;
+  auto GetTLI = [&TLIs](Function &F) -> const TargetLibraryInfo & { return TLIs.get(F); };
+  CFLAndersAAResult andersAA(GetTLI);
+  CFLSteensAAResult steenAA(GetTLI);
+  for (FunctionDependencies &deps : result)
+  {
+    Function &F = *deps.func;
+    if (F.isDeclaration())
+      continue;
+    // the same alias analyses that AAResultsWrapperPass gives MemoryDependenceWrapperPass
+    const TargetLibraryInfo &TLI = TLIs.get(F);
+    AssumptionCache AC(F);
+    DominatorTree DT(F);
+    PhiValues PV(F);
+    BasicAAResult basicAA(F.getParent()->getDataLayout(), F, TLI, AC, &DT, &PV);
+    AAResults AA(TLI);
+    AA.addAAResult(basicAA);
+    AA.addAAResult(steenAA);
+    AA.addAAResult(andersAA);
+    MemoryDependenceResults MD(AA, AC, TLI, DT, PV, MemDepBlockScanLimit);
+    deps.DDG.reset(new DataDependencyGraph());
+    deps.DDG->buildLocal(F, andersAA, steenAA, MD);
+  }
+  return result;
+}
@@ -0,0 +1,283 @@
+#include "DependencyGraphCache.hpp"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+using namespace llvm;
+
+static const char CacheMagic[8] = {'P', 'D', 'G', 'C', 'A', 'C', 'H', 'E'};
+static const uint32_t CacheVersion = 2;
+// node refs that are not instruction indices
+static const uint32_t EntryRef = 0xffffffff;
+static const uint32_t NullRef = 0xfffffffe;
+
+namespace
+{
+// index of every instruction of a function, in inst_iterator order
+struct InstIndex
+{
+  std::vector<Instruction *> insts;
+  DenseMap<const Instruction *, uint32_t> index;
+
+  explicit InstIndex(Function &F)
+  {
+    for (Instruction &I : instructions(F))
+    {
+      index[&I] = insts.size();
+      insts.push_back(&I);
+    }
+  }
+};
+
+// bounds checked little endian reader over an entry
+class EntryReader
+{
+public:
+  explicit EntryReader(StringRef buf) : buf(buf) {}
+  bool read32(uint32_t &v)
+  {
+    if (buf.size() < 4)
+      return false;
+    v = support::endian::read32le(buf.data());
+    buf = buf.drop_front(4);
+    return true;
+  }
+  bool read8(uint8_t &v)
+  {
+    if (buf.empty())
+      return false;
+    v = buf[0];
+    buf = buf.drop_front(1);
+    return true;
+  }
+  bool readBytes(size_t n, StringRef &v)
+  {
+    if (buf.size() < n)
+      return false;
+    v = buf.take_front(n);
+    buf = buf.drop_front(n);
+    return true;
+  }
+  bool atEnd() const { return buf.empty(); }
+
+private:
+  StringRef buf;
+};
+} // namespace
+
+std::string pdg::DependencyGraphCache::hashFunction(const Function &F)
+{
+  // arguments, blocks and instructions are numbered in order, so only the
+  // names of globals and the printed constants depend on the module
+  DenseMap<const Value *, unsigned> ids;
+  unsigned id = 0;
+  for (const Argument &arg : F.args())
+    ids[&arg] = id++;
+  for (const BasicBlock &BB : F)
+  {
+    ids[&BB] = id++;
+    for (const Instruction &I : BB)
+      ids[&I] = id++;
+  }
+
+  std::string str;
+  raw_string_ostream OS(str);
+  OS << F.getName() << '\n';
+  F.getFunctionType()->print(OS);
+  for (const BasicBlock &BB : F)
+  {
+    OS << "\nbb";
+    for (const Instruction &I : BB)
+    {
+      OS << "\n" << I.getOpcodeName() << ' ';
+      I.getType()->print(OS);
+      if (auto *CI = dyn_cast<CmpInst>(&I))
+        OS << ' ' << CI->getPredicate();
+      if (auto *AI = dyn_cast<AllocaInst>(&I))
+      {
+        OS << ' ';
+        AI->getAllocatedType()->print(OS);
+      }
+      if (auto *GEP = dyn_cast<GetElementPtrInst>(&I))
+      {
+        OS << ' ';
+        GEP->getSourceElementType()->print(OS);
+      }
+      if (auto *CB = dyn_cast<CallBase>(&I))
+      {
+        OS << ' ';
+        CB->getFunctionType()->print(OS);
+      }
+      // incoming blocks of a phi are not operands
+      if (auto *PN = dyn_cast<PHINode>(&I))
+        for (const BasicBlock *BB : PN->blocks())
+          OS << " bb%" << ids.lookup(BB);
+      for (const Use &op : I.operands())
+      {
+        const Value *V = op.get();
+        OS << ' ';
+        auto it = ids.find(V);
+        if (it != ids.end())
+          OS << '%' << it->second;
+        else if (auto *GV = dyn_cast<GlobalValue>(V))
+          OS << '@' << GV->getName();
+        else if (auto *CInt = dyn_cast<ConstantInt>(V))
+          OS << CInt->getValue();
+        else if (isa<MetadataAsValue>(V))
+          OS << "metadata";
+        else
+          V->printAsOperand(OS, false);
+      }
+    }
+  }
+
+  MD5 hash;
+  hash.update(OS.str());
+  MD5::MD5Result result;
+  hash.final(result);
+  return result.digest().str().str();
+}
+
+std::string pdg::DependencyGraphCache::getPath(const Function &F, StringRef kind) const
+{
+  SmallString<128> path(dir);
+  sys::path::append(path, hashFunction(F) + "." + kind);
+  return path.str().str();
+}
+
+bool pdg::DependencyGraphCache::load(Function &F, StringRef kind, DependencyGraph<InstructionWrapper> &G, FunctionInstMap &instMap)
+{
+  ErrorOr<std::unique_ptr<MemoryBuffer>> buf = MemoryBuffer::getFile(getPath(F, kind));
+  if (!buf)
+    return false;
+  EntryReader R((*buf)->getBuffer());
+  InstIndex index(F);
+
+  StringRef magic, name;
+  uint32_t version, nameLen, numInsts, numNodes;
+  if (!R.readBytes(sizeof(CacheMagic), magic) || magic != StringRef(CacheMagic, sizeof(CacheMagic)) ||
+      !R.read32(version) || version != CacheVersion ||
+      !R.read32(nameLen) || !R.readBytes(nameLen, name) || name != F.getName() ||
+      !R.read32(numInsts) || numInsts != index.insts.size() ||
+      !R.read32(numNodes))
+    return false;
+
+  for (uint32_t i = 0; i < numNodes; i++)
+  {
+    uint32_t ref;
+    if (!R.read32(ref))
+      return false;
+    InstructionWrapper *instW = nullptr;
+    if (ref == EntryRef)
+      instW = instMap.getEntryW();
+    else if (ref != NullRef)
+    {
+      if (ref >= numInsts)
+        return false;
+      instW = instMap.get(index.insts[ref]);
+    }
+    G.getNodeByData(instW);
+    // a ref that repeats would not add a node
+    if (G.size() != i + 1)
+      return false;
+  }
+
+  for (uint32_t i = 0; i < numNodes; i++)
+  {
+    uint32_t numLinks;
+    if (!R.read32(numLinks))
+      return false;
+    for (uint32_t l = 0; l < numLinks; l++)
+    {
+      uint32_t to;
+      uint8_t type;
+      if (!R.read32(to) || !R.read8(type) || to >= numNodes ||
+          type > static_cast<uint8_t>(DependencyType::GLOBAL_DEP))
+        return false;
+      G.getNodeById(i)->addDependencyTo(G.getNodeById(to), static_cast<DependencyType>(type));
+    }
+  }
+  return R.atEnd();
+}
+
+bool pdg::DependencyGraphCache::store(Function &F, StringRef kind, DependencyGraph<InstructionWrapper> &G)
+{
+  InstIndex index(F);
+  std::string data;
+  raw_string_ostream OS(data);
+  support::endian::Writer W(OS, support::little);
+  OS.write(CacheMagic, sizeof(CacheMagic));
+  W.write<uint32_t>(CacheVersion);
+  W.write<uint32_t>(F.getName().size());
+  OS << F.getName();
+  W.write<uint32_t>(index.insts.size());
+  W.write<uint32_t>(G.size());
+  for (DependencyNode<InstructionWrapper> *node : G.getNodeSet())
+  {
+    const InstructionWrapper *instW = node->getData();
+    if (instW == nullptr)
+      W.write<uint32_t>(NullRef);
+    else if (instW->getGraphNodeType() == GraphNodeType::ENTRY)
+      W.write<uint32_t>(EntryRef);
+    else
+    {
+      auto it = index.index.find(instW->getInstruction());
+      // only graphs of plain instructions of F can be cached
+      if (instW->getGraphNodeType() != GraphNodeType::INST || it == index.index.end())
+        return false;
+      W.write<uint32_t>(it->second);
+    }
+  }
+  for (DependencyNode<InstructionWrapper> *node : G.getNodeSet())
+  {
+    W.write<uint32_t>(node->getDependencyList().size());
+    for (auto &link : node->getDependencyList())
+    {
+      W.write<uint32_t>(link.first->getId());
+      W.write<uint8_t>(static_cast<uint8_t>(link.second));
+    }
+  }
+  OS.flush();
+
+  // write to a temporary file first, so readers never see half an entry
+  if (sys::fs::create_directories(dir))
+    return false;
+  SmallString<128> model(dir);
+  sys::path::append(model, "%%%%%%%%.tmp");
+  Expected<sys::fs::TempFile> tmp = sys::fs::TempFile::create(model);
+  if (!tmp)
+  {
+    consumeError(tmp.takeError());
+    return false;
+  }
+  {
+    raw_fd_ostream out(tmp->FD, false);
+    out << data;
+  }
+  if (Error err = tmp->keep(getPath(F, kind)))
+  {
+    consumeError(std::move(err));
+    return false;
+  }
+  return true;
+}
+
+pdg::ControlDependencyGraph2 *pdg::DependencyGraphCache::loadCDG(Function &F, bool blockLevel)
+{
+  ControlDependencyGraph2 *CDG = new ControlDependencyGraph2(&F, blockLevel);
+  if (load(F, blockLevel ? "cdg-block" : "cdg-inst", *CDG->CDG, CDG->instMap))
+    return CDG;
+  delete CDG;
+  return nullptr;
+}
+
+bool pdg::DependencyGraphCache::storeCDG(ControlDependencyGraph2 &CDG)
+{
+  return store(*CDG.Func, CDG.blockLevel ? "cdg-block" : "cdg-inst", *CDG.CDG);
+}
@@ -6,7 +6,9 @@ void DependencyNode<NodeT>::addDependencyTo(DependencyNode<NodeT> *pNode, Depend
   if (pNode == this)
     return;
   DependencyLink link = DependencyLink(pNode, type);
-  if (std::find(dependencyList.begin(), dependencyList.end(), link) == dependencyList.end())
+  // the list only has to be scanned when pNode is already linked with another type
+  if (dependsOn.test_and_set(pNode->getId()) ||
+      std::find(dependencyList.begin(), dependencyList.end(), link) == dependencyList.end())
   {
     dependencyList.push_back(link);
   }
@@ -19,14 +21,7 @@ bool DependencyNode<NodeT>::isDepends(const DependencyNode<NodeT> *dNode)
   {
     throw DependencyNodeIsNullptrException("Dependency Node is nullptr.");
   }
-  for (auto link : dependencyList)
-  {
-    if (link.first == dNode)
-    {
-      return true;
-    }
-  }
-  return false;
+  return dependsOn.test(dNode->getId());
 }
 
 template <typename NodeT>
@@ -37,6 +32,8 @@ DependencyType DependencyNode<NodeT>::getDependencyType(const DependencyNode<Nod
     throw DependencyNodeIsNullptrException("Dependency Node is nullptr.");
   }
 
+  if (!dependsOn.test(dNode->getId()))
+    return DependencyType::NO_DEPENDENCY;
   for (auto link : dependencyList)
   {
     if (link.first == dNode)
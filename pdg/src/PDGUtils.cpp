@@ -5,6 +5,8 @@ using namespace llvm;
 
 void pdg::PDGUtils::constructInstMap(Function &F)
 {
+  if (!G_wrappedFuncs.insert(&F).second)
+    return;
   for (inst_iterator I = inst_begin(F); I != inst_end(F); ++I)
   {
     if (G_instMap.find(&*I) == G_instMap.end())
@@ -16,21 +18,25 @@ void pdg::PDGUtils::constructInstMap(Function &F)
   }
 }
 
-void pdg::PDGUtils::constructFuncMap(Module &M)
+// wrap a single function on demand, per-function graphs should not pay for the whole module
+void pdg::PDGUtils::constructFuncMap(Function &F)
 {
-  for (Module::iterator FI = M.begin(); FI != M.end(); ++FI)
+  if (F.isDeclaration())
+    return;
+  constructInstMap(F);
+  if (G_funcMap.find(&F) == G_funcMap.end())
   {
-    if (FI->isDeclaration())
-      continue;
-    constructInstMap(*FI);
-    if (G_funcMap.find(&*FI) == G_funcMap.end())
-    {
-      FunctionWrapper *funcW = new FunctionWrapper(&*FI);
-      G_funcMap[&*FI] = funcW;
-    }
+    FunctionWrapper *funcW = new FunctionWrapper(&F);
+    G_funcMap[&F] = funcW;
   }
 }
 
+void pdg::PDGUtils::constructFuncMap(Module &M)
+{
+  for (Module::iterator FI = M.begin(); FI != M.end(); ++FI)
+    constructFuncMap(*FI);
+}
+
 void pdg::PDGUtils::collectGlobalInsts(Module &M)
 {
   for (Module::global_iterator globalIt = M.global_begin(); globalIt != M.global_end(); ++globalIt)
@@ -41,24 +47,37 @@ void pdg::PDGUtils::collectGlobalInsts(Module &M)
 }
 
 void pdg::PDGUtils::categorizeInstInFunc(Function &F)
+{
+  categorizeInstInFunc(F, *G_funcMap[&F]);
+}
+
+void pdg::PDGUtils::categorizeInstInFunc(Function &F, FunctionWrapper &funcW)
 {
   // sort store/load/return/CallInst in function
   for (inst_iterator I = inst_begin(F), IE = inst_end(F); I != IE; ++I)
   {
     Instruction *inst = dyn_cast<Instruction>(&*I);
     if (isa<StoreInst>(inst))
-      G_funcMap[&F]->addStoreInst(inst);
+      funcW.addStoreInst(inst);
 
     if (isa<LoadInst>(inst))
-      G_funcMap[&F]->addLoadInst(inst);
+      funcW.addLoadInst(inst);
 
     if (isa<ReturnInst>(inst))
-      G_funcMap[&F]->addReturnInst(inst);
+      funcW.addReturnInst(inst);
 
     if (isa<CallInst>(inst))
-      G_funcMap[&F]->addCallInst(inst);
+      funcW.addCallInst(inst);
 
     if (isa<CastInst>(inst))
-      G_funcMap[&F]->addCastInst(inst);
+      funcW.addCastInst(inst);
   }
 }
+
+const pdg::TypeTree &pdg::PDGUtils::getTypeTree(Type *ty, int depth)
+{
+  auto &typeTree = G_typeTreeMap[std::make_pair(ty, depth)];
+  if (!typeTree)
+    typeTree.reset(new TypeTree(ty, depth));
+  return *typeTree;
+}
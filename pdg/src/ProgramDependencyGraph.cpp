@@ -236,7 +236,7 @@ void pdg::ProgramDependencyGraph::buildFormalTreeForFunc(Function *Func)
     // build formal in tree first
     buildFormalTreeForArg(*argW->getArg(), TreeType::FORMAL_IN_TREE);
     // then, copy formal in tree content to formal out tree
-    argW->copyTree(argW->getTree(TreeType::FORMAL_IN_TREE), TreeType::FORMAL_OUT_TREE);
+    argW->copyTree(*argW, TreeType::FORMAL_OUT_TREE);
   }
   pdgUtils.getFuncMap()[Func]->setTreeFlag(true);
 }
@@ -247,178 +247,44 @@ void pdg::ProgramDependencyGraph::buildFormalTreeForArg(Argument &arg, TreeType
   Function *Func = arg.getParent();
   try
   {
-    InstructionWrapper *treeTyW = new TreeTypeWrapper(arg.getParent(), GraphNodeType::FORMAL_IN, &arg, arg.getType(), nullptr, 0);
-    pdgUtils.getFuncInstWMap()[Func].insert(treeTyW);
     //find the right arg, and set tree root
     ArgumentWrapper *argW = pdgUtils.getFuncMap()[Func]->getArgWByArg(arg);
-    auto treeRoot = argW->getTree(treeTy).set_head(treeTyW);
-    if (argW->getTree(treeTy).size() == 0) {
-      std::string err_msg = "Function " + Func->getName().str() +
-                            " has param tree of size 0. Abort...";
-      errs() << err_msg << "\n" ;
-      exit(0);
-    }
-    std::string Str;
-    raw_string_ostream OS(Str);
-    //FILE*, bypass, no need to buildTypeTree
-    if ("%struct._IO_FILE*" == OS.str() || "%struct._IO_marker*" == OS.str())
-    {
-      errs() << "OS.str() = " << OS.str() << " FILE* appears, stop buildTypeTree\n";
-    }
-    else if (treeTyW->getTreeNodeType()->isPointerTy() && treeTyW->getTreeNodeType()->getContainedType(0)->isFunctionTy())
-    {
-      errs() << *arg.getParent()->getFunctionType() << " DEBUG 312: in buildFormalTree: function pointer arg = " << *treeTyW->getTreeNodeType() << "\n";
-    }
+    if (argW == nullptr)
+      throw new ArgWrapperIsNullPtr("Argument Wrapper is nullptr");
+    // the shape only depends on the type, function pointer args stay a single node
+    const TypeTree &shape = pdgUtils.getTypeTree(arg.getType(), EXPAND_LEVEL);
+    // GEPs reachable from arg, collected once for all the fields of the tree
+    std::set<InstructionWrapper *> relevantGEPs;
+    bool hasRelevantGEPs = false;
+    argW->buildTree(shape, treeTy, [&](const TypeTree::Node &node) {
+      GraphNodeType nodeTy = node.parent == -1 ? GraphNodeType::FORMAL_IN : GraphNodeType::PARAMETER_FIELD;
+      // field sensitive processing. Get correspond gep and link tree node with gep.
+      InstructionWrapper *gepInstW = nullptr;
+      if (node.isField)
+      {
+        if (!hasRelevantGEPs)
+        {
+          relevantGEPs = getAllRelevantGEP(arg);
+          hasRelevantGEPs = true;
+        }
+        gepInstW = getTreeNodeGEP(relevantGEPs, node.offset, node.type, node.parentType);
+      }
+      InstructionWrapper *treeTyW = new TreeTypeWrapper(Func, nodeTy, &arg, node.type, node.parentType, node.offset, gepInstW);
+      // link gep with tree node
+      if (gepInstW != nullptr)
+        PDG->addDependency(treeTyW, gepInstW, DependencyType::STRUCT_FIELDS);
+      pdgUtils.getFuncInstWMap()[Func].insert(treeTyW);
+      return treeTyW;
+    });
+    if (arg.getType()->isPointerTy() && arg.getType()->getContainedType(0)->isFunctionTy())
+      errs() << *Func->getFunctionType() << " DEBUG 312: in buildFormalTree: function pointer arg = " << *arg.getType() << "\n";
     else
-    {
-        buildTypeTree(arg, treeTyW, treeTy);
-        errs() << "ARGW size: " << argW->getTree(treeTy).size() << "\n";
-    }
+      errs() << "ARGW size: " << argW->getTree(treeTy).size() << "\n";
   } catch (std::exception &e) {
     errs() << e.what() << "\n";
   }
 }
 
-bool pdg::ProgramDependencyGraph::hasRecursiveType(ArgumentWrapper *argW, tree<InstructionWrapper *>::iterator insert_loc)
-{
-  TreeType treeTy = TreeType::FORMAL_IN_TREE;
-  int height = argW->getTree(treeTy).depth(insert_loc);
-  if (height != 0)
-  {
-    bool recursion_flag = false;
-    tree<InstructionWrapper *>::iterator backTreeIt = insert_loc;
-    while (height > 0)
-    {
-      backTreeIt = argW->getTree(treeTy).parent(backTreeIt);
-      if ((*insert_loc)->getTreeNodeType() == (*backTreeIt)->getTreeNodeType())
-      {
-        recursion_flag = true;
-        break;
-      }
-      height -= 1;
-    }
-    // process next type, because this type brings in a recursion
-    if (recursion_flag)
-      return true;
-  }
-  return false;
-}
-
-bool pdg::ProgramDependencyGraph::isFilePtrOrFuncTy(Type *ty)
-{
-  //if field is a function Ptr
-  if (ty->isFunctionTy())
-  {
-    std::string Str;
-    raw_string_ostream OS(Str);
-    OS << ty;
-    return true;
-  }
-
-  if (ty->isPointerTy())
-  {
-    Type *childEleTy = dyn_cast<PointerType>(ty)->getElementType();
-    if (childEleTy->isStructTy())
-    {
-      std::string Str;
-      raw_string_ostream OS(Str);
-      OS << ty;
-      //FILE*, bypass, no need to buildTypeTree
-      if ("%struct._IO_FILE*" == OS.str() || "%struct._IO_marker*" == OS.str())
-        return true;
-    }
-  }
-  return false;
-}
-
-InstructionWrapper *pdg::ProgramDependencyGraph::buildPointerTypeNode(ArgumentWrapper *argW, InstructionWrapper *curTyNode, tree<InstructionWrapper *>::iterator insert_loc)
-{
-  auto &pdgUtils = PDGUtils::getInstance();
-  TreeType treeTy = TreeType::FORMAL_IN_TREE;
-  Argument &arg = *argW->getArg();
-  PointerType *pt = dyn_cast<PointerType>(curTyNode->getTreeNodeType());
-  Type *pointedNodeTy = pt->getElementType();
-  InstructionWrapper *pointedTypeW = new TreeTypeWrapper(arg.getParent(),
-                                                         GraphNodeType::PARAMETER_FIELD,
-                                                         &arg,
-                                                         pointedNodeTy,
-                                                         curTyNode->getTreeNodeType(),
-                                                         0);
-  pdgUtils.getFuncInstWMap()[arg.getParent()].insert(pointedTypeW);
-  argW->getTree(treeTy).append_child(insert_loc, pointedTypeW);
-  return pointedTypeW;
-}
-
-void pdg::ProgramDependencyGraph::buildTypeTree(Argument &arg, InstructionWrapper *treeTyW, TreeType treeTy)
-{
-  auto &pdgUtils = PDGUtils::getInstance();
-  Function *Func = arg.getParent();
-  // setup instWQ to avoid recusion processing
-  std::queue<InstructionWrapper *> instWQ;
-  instWQ.push(treeTyW);
-  ArgumentWrapper *argW = pdgUtils.getFuncMap()[Func]->getArgWByArg(arg);
-
-  if (argW == nullptr)
-    throw new ArgWrapperIsNullPtr("Argument Wrapper is nullptr");
-
-  tree<InstructionWrapper *>::iterator insert_loc; // insert location in the parameter tree for the type wrapper
-  int depth = 0;
-  while (!instWQ.empty())
-  {
-    if (depth >= EXPAND_LEVEL)
-      return;
-    depth += 1;
-    int qSize = instWQ.size();
-    while (qSize > 0)
-    {
-      qSize -= 1;
-      InstructionWrapper *curTyNode = instWQ.front();
-      instWQ.pop();
-      insert_loc = getInstInsertLoc(argW, curTyNode, treeTy);
-      // handle recursion type using 1-limit approach
-      // track back from child to parent, if find same type, stop building.
-      // The type used here is form llvm type system.
-      if (hasRecursiveType(argW, insert_loc))
-        continue;
-      // if is pointer type, create node for the pointed type
-      Type *curNodeTy = curTyNode->getTreeNodeType();
-      if (curNodeTy->isPointerTy())
-      {
-        InstructionWrapper *pointedTypeW = buildPointerTypeNode(argW, curTyNode, insert_loc);
-        instWQ.push(pointedTypeW); // put the pointed node to queue
-        continue;
-      }
-      // compose for struct
-      if (!curNodeTy->isStructTy())
-        continue;
-      // processs non-pointer type
-      Type *parentType = nullptr;
-      // for struct type, insert all children to the tree
-      for (unsigned int child_offset = 0; child_offset < curNodeTy->getNumContainedTypes(); child_offset++)
-      {
-        parentType = curTyNode->getTreeNodeType();
-        // field sensitive processing. Get correspond gep and link tree node with gep.
-        Type *childType = curNodeTy->getContainedType(child_offset);
-        InstructionWrapper *gepInstW = getTreeNodeGEP(arg, child_offset, childType, parentType);
-        InstructionWrapper *typeFieldW = new TreeTypeWrapper(arg.getParent(), GraphNodeType::PARAMETER_FIELD, &arg, childType, parentType, child_offset, gepInstW);
-        // link gep with tree node
-        if (gepInstW != nullptr)
-          PDG->addDependency(typeFieldW, gepInstW, DependencyType::STRUCT_FIELDS);
-
-        pdgUtils.getFuncInstWMap()[arg.getParent()].insert(typeFieldW);
-        // start inserting formal tree instructions
-        argW->getTree(treeTy).append_child(insert_loc, typeFieldW);
-
-        //skip function ptr, FILE*
-        if (isFilePtrOrFuncTy(childType))
-          continue;
-
-        instWQ.push(typeFieldW);
-      }
-    }
-  }
-}
-
 void pdg::ProgramDependencyGraph::drawFormalParameterTree(Function *Func, TreeType treeTy)
 {
   auto &pdgUtils = PDGUtils::getInstance();
@@ -579,12 +445,12 @@ bool pdg::ProgramDependencyGraph::connectCallerAndCallee(InstructionWrapper *cal
       {
         if ((*actual_out_TI)->getTreeNodeType() != loadInst->getType())
           continue;
-
-        for (InstructionWrapper *tmpInstW : pdgUtils.getFuncInstWMap()[callee])
-        {
-          if (tmpInstW->getInstruction() == dyn_cast<Instruction>(loadInst))
-            PDG->addDependency(*actual_out_TI, tmpInstW, DependencyType::DATA_GENERAL);
-        }
+        // the load is in the caller, so callee only wraps it for a recursive call
+        if (loadInst->getFunction() != callee)
+          continue;
+        InstructionWrapper *tmpInstW = pdgUtils.getInstMap()[loadInst];
+        if (pdgUtils.getFuncInstWMap()[callee].count(tmpInstW))
+          PDG->addDependency(*actual_out_TI, tmpInstW, DependencyType::DATA_GENERAL);
       }
     }
   }
@@ -665,8 +531,8 @@ void pdg::ProgramDependencyGraph::buildActualParameterTrees(CallInst *CI)
   //copy Formal Tree to Actual Tree. Actual trees are used by call site.
   for (; argI != argE && argFI != argFE; ++argI, ++argFI)
   {
-    (*argI)->copyTree((*argFI)->getTree(TreeType::FORMAL_IN_TREE), TreeType::ACTUAL_IN_TREE);
-    (*argI)->copyTree((*argFI)->getTree(TreeType::FORMAL_IN_TREE), TreeType::ACTUAL_OUT_TREE);
+    (*argI)->copyTree(**argFI, TreeType::ACTUAL_IN_TREE);
+    (*argI)->copyTree(**argFI, TreeType::ACTUAL_OUT_TREE);
   }
 }
 
@@ -750,10 +616,14 @@ std::set<pdg::InstructionWrapper *> pdg::ProgramDependencyGraph::getAllRelevantG
     }
   }
 
+  // def-use chains through phis are cyclic, visit every inst once
+  std::set<InstructionWrapper *> seen;
   while (!instWQ.empty())
   {
     InstructionWrapper *instW = instWQ.front();
     instWQ.pop();
+    if (!seen.insert(instW).second)
+      continue;
 
     auto dataDList = PDG->getNodeDepList(instW);
     for (auto depPair : dataDList)
@@ -772,9 +642,8 @@ std::set<pdg::InstructionWrapper *> pdg::ProgramDependencyGraph::getAllRelevantG
   return relevantGEPs;
 }
 
-InstructionWrapper *pdg::ProgramDependencyGraph::getTreeNodeGEP(Argument &arg, unsigned field_offset, Type *treeNodeTy, Type *parentNodeTy)
+InstructionWrapper *pdg::ProgramDependencyGraph::getTreeNodeGEP(const std::set<InstructionWrapper *> &RelevantGEPList, unsigned field_offset, Type *treeNodeTy, Type *parentNodeTy)
 {
-  std::set<InstructionWrapper *> RelevantGEPList = getAllRelevantGEP(arg);
   for (auto GEPInstW : RelevantGEPList)
   {
     int operand_num = GEPInstW->getInstruction()->getNumOperands();
@@ -849,16 +718,6 @@ bool pdg::ProgramDependencyGraph::isFuncTypeMatch(FunctionType *funcTy1, Functio
   return true;
 }
 
-tree<pdg::InstructionWrapper *>::iterator pdg::ProgramDependencyGraph::getInstInsertLoc(pdg::ArgumentWrapper *argW, InstructionWrapper *tyW, TreeType treeTy)
-{
-  tree<pdg::InstructionWrapper *>::iterator insert_loc = argW->getTree(treeTy).begin();
-  while ((*insert_loc) != tyW && insert_loc != argW->getTree(treeTy).end())
-  {
-    insert_loc++;
-  }
-  return insert_loc;
-}
-
 typename pdg::DependencyNode<pdg::InstructionWrapper>::DependencyLinkList pdg::ProgramDependencyGraph::getNodeDepList(Instruction *inst)
 {
   return PDG->getNodeDepList(PDGUtils::getInstance().getInstMap()[inst]);
@@ -0,0 +1,80 @@
+#include "TypeTree.hpp"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+pdg::TypeTree::TypeTree(Type *rootTy, int depth)
+{
+  nodes.push_back({rootTy, nullptr, 0, -1, false});
+  // function pointer args are not expanded
+  if (rootTy->isPointerTy() && rootTy->getContainedType(0)->isFunctionTy())
+    return;
+
+  std::vector<unsigned> level{0};
+  for (int d = 0; d < depth && !level.empty(); d++)
+  {
+    std::vector<unsigned> nextLevel;
+    for (unsigned idx : level)
+    {
+      // handle recursion type using 1-limit approach
+      // track back from child to parent, if find same type, stop building.
+      if (hasRecursiveType(idx))
+        continue;
+      // copy, nodes may grow below
+      Type *curNodeTy = nodes[idx].type;
+      // if is pointer type, create node for the pointed type
+      if (curNodeTy->isPointerTy())
+      {
+        nodes.push_back({curNodeTy->getPointerElementType(), curNodeTy, 0, (int)idx, false});
+        nextLevel.push_back(nodes.size() - 1);
+        continue;
+      }
+      if (!curNodeTy->isStructTy())
+        continue;
+      // for struct type, insert all children to the tree
+      for (unsigned child_offset = 0; child_offset < curNodeTy->getNumContainedTypes(); child_offset++)
+      {
+        Type *childType = curNodeTy->getContainedType(child_offset);
+        nodes.push_back({childType, curNodeTy, (int)child_offset, (int)idx, true});
+        //skip function ptr, FILE*
+        if (isFilePtrOrFuncTy(childType))
+          continue;
+        nextLevel.push_back(nodes.size() - 1);
+      }
+    }
+    level.swap(nextLevel);
+  }
+}
+
+bool pdg::TypeTree::hasRecursiveType(unsigned idx) const
+{
+  for (int p = nodes[idx].parent; p != -1; p = nodes[p].parent)
+  {
+    if (nodes[p].type == nodes[idx].type)
+      return true;
+  }
+  return false;
+}
+
+bool pdg::TypeTree::isFilePtrOrFuncTy(Type *ty)
+{
+  //if field is a function Ptr
+  if (ty->isFunctionTy())
+    return true;
+
+  if (ty->isPointerTy())
+  {
+    Type *childEleTy = dyn_cast<PointerType>(ty)->getElementType();
+    if (childEleTy->isStructTy())
+    {
+      std::string Str;
+      raw_string_ostream OS(Str);
+      OS << ty;
+      //FILE*, bypass, no need to buildTypeTree
+      if ("%struct._IO_FILE*" == OS.str() || "%struct._IO_marker*" == OS.str())
+        return true;
+    }
+  }
+  return false;
+}
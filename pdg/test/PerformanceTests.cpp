@@ -0,0 +1,325 @@
+// Tests of the pdg library on synthetic functions. The correctness cases run by
+// default. The scaling cases are hidden behind [.benchmark], since they compare
+// wall-clock times; run them with `pdgPerfTest "[.benchmark]"`. They build
+// functions of growing size, report the time of each size through BENCHMARK and
+// fail when the time grows faster than the size by more than the allowed ratio.
+#define CATCH_CONFIG_MAIN
+// the signal handling of this catch version does not build with newer glibc
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#include "catch2/catch.hpp"
+
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+#include "ControlDependencyGraph2.hpp"
+#include "DependencyGraphBuilder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+
+using namespace llvm;
+
+namespace
+{
+// Times work at every size, the best of `runs` runs, and checks that the time of
+// the largest size over the time of the smallest stays below maxRatio. makeWork
+// prepares the input of a size outside the timed part.
+void checkGrowth(const std::string &name, const std::vector<unsigned> &sizes, double maxRatio,
+                 std::function<std::function<void()>(unsigned)> makeWork, unsigned runs = 3)
+{
+  std::string report;
+  std::vector<double> times;
+  for (unsigned size : sizes)
+  {
+    std::function<void()> work = makeWork(size);
+    double best = 0;
+    auto timeRun = [&]
+    {
+      auto start = std::chrono::steady_clock::now();
+      work();
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      best = best == 0 ? elapsed : std::min(best, elapsed);
+    };
+    BENCHMARK(name + " n=" + std::to_string(size))
+    {
+      timeRun();
+    }
+    for (unsigned i = 1; i < runs; i++)
+      timeRun();
+    times.push_back(best);
+    report += " n=" + std::to_string(size) + ": " + std::to_string(best * 1000) + "ms";
+  }
+  INFO(name << report);
+  CHECK(times.back() / times.front() < maxRatio);
+}
+
+// allowed ratio for sizes that grow by `growth`: linear work grows by growth,
+// quadratic work by growth * growth
+double linearRatio(double growth) { return growth * 2.5; }
+
+// void f(i32 %x) with n switches in a row, every switch has 4 cases that join
+// at the next switch
+Function *buildSwitchChain(Module &M, unsigned n)
+{
+  LLVMContext &C = M.getContext();
+  IRBuilder<> B(C);
+  Function *F = Function::Create(FunctionType::get(B.getVoidTy(), {B.getInt32Ty()}, false),
+                                 Function::ExternalLinkage, "switch_chain", M);
+  Value *x = &*F->arg_begin();
+  BasicBlock *cur = BasicBlock::Create(C, "entry", F);
+  for (unsigned i = 0; i < n; i++)
+  {
+    BasicBlock *next = BasicBlock::Create(C, "sw", F);
+    B.SetInsertPoint(cur);
+    SwitchInst *SI = B.CreateSwitch(x, next, 4);
+    for (unsigned c = 0; c < 4; c++)
+    {
+      BasicBlock *caseBB = BasicBlock::Create(C, "case", F);
+      SI->addCase(B.getInt32(i * 4 + c), caseBB);
+      B.SetInsertPoint(caseBB);
+      B.CreateAdd(x, B.getInt32(c));
+      B.CreateBr(next);
+    }
+    cur = next;
+  }
+  B.SetInsertPoint(cur);
+  B.CreateRetVoid();
+  return F;
+}
+
+// void f(i32 %n) with n loops nested in each other, all of them counting to %n
+Function *buildLoopNest(Module &M, unsigned n)
+{
+  LLVMContext &C = M.getContext();
+  IRBuilder<> B(C);
+  Function *F = Function::Create(FunctionType::get(B.getVoidTy(), {B.getInt32Ty()}, false),
+                                 Function::ExternalLinkage, "loop_nest", M);
+  Value *bound = &*F->arg_begin();
+  BasicBlock *entry = BasicBlock::Create(C, "entry", F);
+  BasicBlock *exit = BasicBlock::Create(C, "exit", F);
+  B.SetInsertPoint(exit);
+  B.CreateRetVoid();
+
+  // pred enters the loop at depth d, after is where the loop exits to
+  BasicBlock *pred = entry;
+  BasicBlock *after = exit;
+  for (unsigned d = 0; d < n; d++)
+  {
+    BasicBlock *header = BasicBlock::Create(C, "header", F);
+    BasicBlock *latch = BasicBlock::Create(C, "latch", F);
+    B.SetInsertPoint(pred);
+    B.CreateBr(header);
+    B.SetInsertPoint(header);
+    PHINode *iv = B.CreatePHI(B.getInt32Ty(), 2);
+    iv->addIncoming(B.getInt32(0), pred);
+    BasicBlock *body = BasicBlock::Create(C, "body", F);
+    B.CreateCondBr(B.CreateICmpSLT(iv, bound), body, after);
+    B.SetInsertPoint(latch);
+    Value *inc = B.CreateAdd(iv, B.getInt32(1));
+    iv->addIncoming(inc, latch);
+    B.CreateBr(header);
+    pred = body;
+    after = latch;
+  }
+  // the innermost body goes back to the innermost latch
+  B.SetInsertPoint(pred);
+  B.CreateBr(after);
+  return F;
+}
+
+// i32 f() with a single block of n stack slots, each written, copied to the next
+// one and read back
+Function *buildMemoryBlock(Module &M, unsigned n)
+{
+  LLVMContext &C = M.getContext();
+  IRBuilder<> B(C);
+  Function *F = Function::Create(FunctionType::get(B.getInt32Ty(), false),
+                                 Function::ExternalLinkage, "memory_block", M);
+  B.SetInsertPoint(BasicBlock::Create(C, "entry", F));
+  std::vector<Value *> slots;
+  for (unsigned i = 0; i < n; i++)
+  {
+    slots.push_back(B.CreateAlloca(B.getInt32Ty()));
+    B.CreateStore(B.getInt32(i), slots.back());
+  }
+  for (unsigned i = 0; i + 1 < n; i++)
+    B.CreateStore(B.CreateLoad(B.getInt32Ty(), slots[i]), slots[i + 1]);
+  Value *sum = B.getInt32(0);
+  for (Value *slot : slots)
+    sum = B.CreateAdd(sum, B.CreateLoad(B.getInt32Ty(), slot));
+  B.CreateRet(sum);
+  return F;
+}
+} // namespace
+
+TEST_CASE("CDG of a switch chain", "[cdg]")
+{
+  LLVMContext C;
+  Module M("test", C);
+  Function *F = buildSwitchChain(M, 3);
+  PostDominatorTree PDT(*F);
+  pdg::ControlDependencyGraph2 CDG(F, &PDT);
+
+  for (BasicBlock &BB : *F)
+  {
+    auto *SI = dyn_cast<SwitchInst>(BB.getTerminator());
+    if (SI == nullptr)
+      continue;
+    pdg::ControlDependencyGraph2::cgdNode *sw = CDG.getNodeForInst(SI);
+    // the cases depend on the switch, the join block postdominates it
+    for (auto &c : SI->cases())
+    {
+      BasicBlock *caseBB = c.getCaseSuccessor();
+      CHECK(sw->isDepends(CDG.getNodeForInst(caseBB->getTerminator())));
+      std::vector<std::vector<Instruction *>> paths;
+      CDG.getRDep(caseBB->getTerminator(), paths);
+      REQUIRE(paths.size() == 1);
+      CHECK(paths[0] == std::vector<Instruction *>{SI});
+    }
+    CHECK_FALSE(sw->isDepends(CDG.getNodeForInst(SI->getDefaultDest()->getTerminator())));
+  }
+}
+
+TEST_CASE("k shortest CDG paths start with the shortest path", "[path]")
+{
+  LLVMContext C;
+  Module M("test", C);
+  Function *F = buildLoopNest(M, 4);
+  PostDominatorTree PDT(*F);
+  pdg::ControlDependencyGraph2 CDG(F, &PDT);
+
+  for (BasicBlock &BB : *F)
+  {
+    Instruction *term = BB.getTerminator();
+    std::vector<std::vector<Instruction *>> shortest, first, paths;
+    CDG.getRDep(term, shortest);
+    CDG.getKRDep(term, 1, first);
+    CDG.getKRDep(term, 3, paths);
+    INFO("block " << BB.getName().str());
+    if (paths.empty())
+    {
+      // only blocks unreachable in the CDG have no path
+      CHECK(first.empty());
+      CHECK(shortest[0].empty());
+      continue;
+    }
+    REQUIRE(first.size() == 1);
+    CHECK(first[0] == shortest[0]);
+    CHECK(paths[0] == shortest[0]);
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+      if (i > 0)
+      {
+        CHECK(paths[i - 1].size() <= paths[i].size());
+        CHECK(paths[i - 1] != paths[i]);
+      }
+      // every step of a path, and its last node to the target, is a CDG edge
+      std::vector<Instruction *> steps = paths[i];
+      steps.push_back(term);
+      for (size_t j = 0; j + 1 < steps.size(); j++)
+        CHECK(CDG.getNodeForInst(steps[j])->isDepends(CDG.getNodeForInst(steps[j + 1])));
+    }
+  }
+}
+
+TEST_CASE("DDG read-after-write edges follow the stored slot", "[ddg]")
+{
+  LLVMContext C;
+  Module M("test", C);
+  Function *F = buildMemoryBlock(M, 4);
+  std::vector<pdg::FunctionDependencies> deps = pdg::buildDependencyGraphs({F}, true, 1);
+  REQUIRE(deps[0].DDG);
+
+  for (Instruction &I : instructions(F))
+  {
+    auto *store = dyn_cast<StoreInst>(&I);
+    if (store == nullptr)
+      continue;
+    std::set<Instruction *> expected, actual;
+    for (User *U : store->getPointerOperand()->users())
+      if (auto *load = dyn_cast<LoadInst>(U))
+        expected.insert(load);
+    for (auto &link : deps[0].DDG->getNodeDepList(store))
+      if (link.second == pdg::DependencyType::DATA_RAW)
+        actual.insert(link.first->getData()->getInstruction());
+    CHECK(actual == expected);
+  }
+}
+
+TEST_CASE("CDG construction scales with the CFG", "[.benchmark][cdg]")
+{
+  LLVMContext C;
+  std::vector<std::unique_ptr<Module>> modules;
+  auto cdgWork = [&](Function *(*build)(Module &, unsigned))
+  {
+    return [&, build](unsigned n) -> std::function<void()>
+    {
+      modules.emplace_back(new Module("bench", C));
+      Function *F = build(*modules.back(), n);
+      return [F]
+      {
+        PostDominatorTree PDT(*F);
+        pdg::ControlDependencyGraph2 CDG(F, &PDT);
+        REQUIRE(CDG._getCDG()->size() > 0);
+      };
+    };
+  };
+
+  SECTION("switch chain")
+  {
+    checkGrowth("CDG switch chain", {500, 1000, 2000}, linearRatio(4), cdgWork(buildSwitchChain));
+  }
+  SECTION("loop nest")
+  {
+    checkGrowth("CDG loop nest", {200, 400, 800}, linearRatio(4), cdgWork(buildLoopNest));
+  }
+}
+
+TEST_CASE("DDG alias phase scales with memory operations", "[.benchmark][ddg]")
+{
+  LLVMContext C;
+  std::vector<std::unique_ptr<Module>> modules;
+  checkGrowth("DDG memory block", {300, 600, 1200}, linearRatio(4), [&](unsigned n) -> std::function<void()>
+              {
+    modules.emplace_back(new Module("bench", C));
+    Function *F = buildMemoryBlock(*modules.back(), n);
+    return [F]
+    {
+      std::vector<pdg::FunctionDependencies> deps = pdg::buildDependencyGraphs({F}, true, 1);
+      REQUIRE(deps[0].DDG);
+    }; });
+}
+
+TEST_CASE("CDG path queries scale with the number of queries", "[.benchmark][path]")
+{
+  LLVMContext C;
+  std::vector<std::unique_ptr<Module>> modules;
+  std::vector<std::unique_ptr<PostDominatorTree>> PDTs;
+  // the shortest paths of all blocks share one BFS, so querying every block is
+  // linear. The k shortest paths need a BFS per query, only a few are asked
+  checkGrowth("CDG path queries switch chain", {500, 1000, 2000}, linearRatio(4), [&](unsigned n) -> std::function<void()>
+              {
+    modules.emplace_back(new Module("bench", C));
+    Function *F = buildSwitchChain(*modules.back(), n);
+    PDTs.emplace_back(new PostDominatorTree(*F));
+    PostDominatorTree *PDT = PDTs.back().get();
+    return [F, PDT]
+    {
+      // a fresh graph, paths are cached per graph
+      pdg::ControlDependencyGraph2 CDG(F, PDT);
+      std::vector<std::vector<Instruction *>> paths;
+      for (BasicBlock &BB : *F)
+        CDG.getRDep(BB.getTerminator(), paths);
+      REQUIRE(paths.size() == F->size());
+      // the last blocks, the deepest of the chain
+      auto BI = F->end();
+      for (unsigned queries = 0; queries < 8 && BI != F->begin(); queries++)
+        CDG.getKRDep((--BI)->getTerminator(), 3, paths);
+    }; });
+}
@@ -2,6 +2,7 @@
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "Graphs/SVFGOPT.h"
 #include "MSSA/MemSSA.h"
@@ -14,12 +15,16 @@
 #include "WPA/Andersen.h"
 #include "WPA/VersionedFlowSensitive.h"
 
+#include "NoReturnFilter.h"
+
 using namespace llvm;
 using namespace std;
 using namespace SVF;
 
 const Option<std::string> libPath("lib", "path to the bc file", "");
 const Option<std::string> dotPath("o", "path to the dot file", "");
+const Option<bool> noReturnFilter("noreturn-filter", "also remove the calls dominated by calls that never return", true);
+const Option<u32_t> numThreads("j", "number of threads used to find unexecutable blocks, 0 for all cores", 0);
 
 LLVMModuleSet* svfModuleSet;
 SVFIR* pag;
@@ -149,17 +154,20 @@ public:
         llvm_unreachable("SCCP: Don't know how to handle this terminator!");
     }
 
-    void handleUnExecutableBB(BasicBlock& b, set<const SVF::CallICFGNode*>& unreachedICFGNodes)
+    static void handleUnExecutableBB(BasicBlock& b, set<const SVF::CallICFGNode*>& unreachedICFGNodes)
     {
         errs()<<"unreached BB in "<<b.getParent()->getName() <<"\n";
         for (auto& i : b)
+            handleUnExecutableInst(i, unreachedICFGNodes);
+    }
+
+    static void handleUnExecutableInst(Instruction& i, set<const SVF::CallICFGNode*>& unreachedICFGNodes)
+    {
+        auto inst = svfModuleSet->getSVFInstruction(&i);
+        if (SVFUtil::isCallSite(inst) && SVFUtil::isNonInstricCallSite(inst))
         {
-            auto inst = svfModuleSet->getSVFInstruction(&i);
-            if (SVFUtil::isCallSite(inst) && SVFUtil::isNonInstricCallSite(inst))
-            {
-                auto node = pag->getICFG()->getCallICFGNode(inst);
-                unreachedICFGNodes.insert(node);
-            }
+            auto node = pag->getICFG()->getCallICFGNode(inst);
+            unreachedICFGNodes.insert(node);
         }
     }
 
@@ -191,7 +199,9 @@ public:
     { /*returns void*/
     }
 
-    void run(Function& f, set<const SVF::CallICFGNode*>& unreachedICFGNodes)
+    // 只读llvm IR，可以在多个线程中各自使用一个CGVisitor；
+    // 查询SVF的部分不是线程安全的，留给handleUnExecutableBB在主线程中完成
+    void run(Function& f, vector<BasicBlock*>& unExecutableBBs)
     {
         if (f.isDeclaration())
             return;
@@ -209,7 +219,7 @@ public:
 
         for (auto& b : f.getBasicBlockList())
             if (BBExecutable.find(&b) == BBExecutable.end())
-                handleUnExecutableBB(b, unreachedICFGNodes);
+                unExecutableBBs.push_back(&b);
         BBExecutable.clear();
     }
 };
@@ -240,11 +250,40 @@ int main(int argc, char** argv)
     // GraphPrinter::WriteGraphToFile(errs(), "ptacg", cg);
     auto ci2edge = cg->getCallInstToCallGraphEdgesMap();
 
-    set<const SVF::CallICFGNode*> unreachedICFGNodes;
-    CGVisitor v;
+    vector<Function*> funcs;
     for (auto& f : *module)
+        funcs.push_back(&f);
+    vector<vector<BasicBlock*>> unExecutableBBs(funcs.size());
+    {
+        ThreadPool pool(hardware_concurrency(numThreads()));
+        unsigned n = pool.getThreadCount();
+        for (unsigned t = 0; t < n; t++)
+            pool.async([&, t]
+            {
+                CGVisitor v;
+                for (size_t i = t; i < funcs.size(); i += n)
+                    v.run(*funcs[i], unExecutableBBs[i]);
+            });
+        pool.wait();
+    }
+
+    // 被不会返回的调用支配的call同样不会执行
+    vector<SmallVector<pair<CallInst*, Instruction*>, 4>> deadCalls(funcs.size());
+    if (noReturnFilter())
+    {
+        NoReturnFilter filter;
+        filter.run(*module);
+        for (size_t i = 0; i < funcs.size(); i++)
+            filter.findDeadCalls(*funcs[i], deadCalls[i]);
+    }
+
+    set<const SVF::CallICFGNode*> unreachedICFGNodes;
+    for (size_t i = 0; i < funcs.size(); i++)
     {
-        v.run(f, unreachedICFGNodes);
+        for (auto b : unExecutableBBs[i])
+            CGVisitor::handleUnExecutableBB(*b, unreachedICFGNodes);
+        for (auto& dc : deadCalls[i])
+            CGVisitor::handleUnExecutableInst(*dc.first, unreachedICFGNodes);
         for (auto ci : unreachedICFGNodes)
         {
             auto edges = ci2edge.find(ci);
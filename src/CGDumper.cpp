@@ -1,4 +1,6 @@
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SparseBitVector.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/Support/GraphWriter.h"
@@ -18,22 +20,55 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/GlobPattern.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Transforms/Utils/SCCPSolver.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/ValueLatticeUtils.h"
 
 #include "ControlDependencyGraph2.hpp"
+#include "DependencyGraphBuilder.hpp"
 #include "llvm/Analysis/PostDominators.h"
 #include "llvm/ADT/GraphTraits.h"
 
+#include <chrono>
+
 #include "Analyzer.h"
 #include "CallGraph.h"
 #include "Config.h"
+#include "NoReturnFilter.h"
 
 using namespace llvm;
 
 cl::opt<std::string> libPath(cl::Positional, cl::desc("<input bitcode files>"));
+cl::list<std::string> libModules("lib", cl::CommaSeparated, cl::desc("library bitcode files analyzed together with the input, instead of a linked module"), cl::value_desc("filename"));
 cl::opt<string> OutputFilename("o", cl::init("mltacg.dot"), cl::desc("Specify output filename"), cl::value_desc("filename"));
+enum OutputFormatTy
+{
+  DotFormat,
+  BinaryFormat,
+  JSONLinesFormat
+};
+cl::opt<OutputFormatTy> outputFormat("format", cl::init(DotFormat), cl::desc("output format of the callgraph"),
+                                     cl::values(clEnumValN(DotFormat, "dot", "graphviz dot"),
+                                                clEnumValN(BinaryFormat, "bin", "binary adjacency lists with a string table"),
+                                                clEnumValN(JSONLinesFormat, "jsonl", "one json object per node and per edge")));
 cl::opt<bool> reduceCG("r", cl::init(false), cl::desc("reduce the callgraph"));
+cl::opt<unsigned> numThreads("j", cl::init(0), cl::desc("number of threads used to find unexecutable blocks and build depInfo, 0 for all cores"));
+cl::opt<std::string> depCacheDir("dep-cache", cl::init(""), cl::desc("directory caching the cdg of each function for depInfo, keyed by the hash of the function name and body"));
+cl::opt<bool> ipsccp("ipsccp", cl::init(false), cl::desc("reduce the callgraph with interprocedural sparse conditional constant propagation"));
+cl::opt<bool> noReturnFilter("noreturn-filter", cl::init(true), cl::desc("also reduce the calls dominated by calls that never return"));
+cl::opt<bool> provenance("provenance", cl::init(false), cl::desc("report why each edge was reduced"));
 cl::opt<bool> depInfo("depInfo", cl::init(false), cl::desc("show dep info"));
+cl::opt<bool> diffCG("diff", cl::init(false), cl::desc("report the reachability of the targets in the original and the reduced callgraph"));
+cl::list<std::string> diffTargets("targets", cl::CommaSeparated, cl::desc("glob patterns of the target functions for -diff and -witness"), cl::value_desc("pattern"));
+cl::opt<bool> cgStats("cg-stats", cl::init(false), cl::desc("print json statistics of the original and the reduced callgraph"));
+cl::opt<unsigned> statsTop("top", cl::init(10), cl::desc("number of functions and indirect call sites listed by -cg-stats"));
+cl::opt<bool> witness("witness", cl::init(false), cl::desc("print a call path from main to each reachable target"));
+cl::opt<bool> mltaStats("mlta-stats", cl::init(false), cl::desc("print load factor and probe lengths of the MLTA type tables"));
 
 class MLTACGDOTInfo;
 struct MLTACG_Node;
@@ -47,96 +82,81 @@ string BB2label(BasicBlock *bb)
   return SO.str().str();
 }
 
+// call graph以CSR形式保存，边只记录dst的id，node的出边在edges中连续存放
 struct MLTACG_Edge
 {
-  MLTACG_Node *src;
-  MLTACG_Node *dst;
+  uint32_t src;
+  uint32_t dst;
   CallInst *callSite;
-  bool reduced;
-  bool reached;
 
-  MLTACG_Edge(MLTACG_Node *src, MLTACG_Node *dst, CallInst *cs)
-  {
-    this->src = src;
-    this->dst = dst;
-    callSite = cs;
-    reduced = false;
-    reached = false;
-  }
+  MLTACG_Edge(uint32_t src, uint32_t dst, CallInst *cs) : src(src), dst(dst), callSite(cs) {}
+};
+
+// edge被reduce的原因
+enum ReduceCause : uint8_t
+{
+  NotReduced,
+  FoldedBranch,      // 所在BB被常量分支排除
+  DeadBlock,         // 所在BB没有可执行的前驱
+  SCCPInfeasible,    // 所在BB被SCCPSolver证明不可执行
+  CallerReduced,     // caller在updateReduced中被reduce
+  NoReturnDominated, // 被不会返回的调用支配
+  Uncalled,          // caller从未被调用，没有in边
+  NumCauses,
+};
+
+static const char *causeName(uint8_t cause)
+{
+  static const char *names[] = {"none", "folded-branch", "dead-block", "sccp-infeasible", "caller-reduced", "noreturn-dominated", "uncalled"};
+  return names[cause];
+}
+
+// 不可执行BB中的call ins，decider为排除该BB的terminator
+struct ReducedCallSite
+{
+  CallInst *callSite;
+  uint8_t cause;
+  Instruction *decider;
 };
 
 struct MLTACG_Node
 {
-  // depInfo
+  // depInfo，仅为printReachedInfo访问到的node由buildDepInfo构建
   using pathVector = std::vector<std::vector<Instruction *>>;
-  pdg::ControlDependencyGraph2 *cdg;
-  llvm::PostDominatorTree *pdt;
-  std::map<Instruction *, pathVector> pathMap;              // 每条call ins的cdg path集合
+  pdg::ControlDependencyGraph2 *cdg = nullptr;
+  llvm::PostDominatorTree *pdt = nullptr;
+  mutable std::map<Instruction *, uint64_t> minDepMap;      // 每条call ins的最短cdg path长度，按需计算
   std::map<MLTACG_Node *, std::set<Instruction *>> callMap; // 每个child对应的call ins
 
   Function *func;
-  set<MLTACG_Edge *> in_edges;
-  set<MLTACG_Edge *> out_edges;
-  bool reduced;
-  bool reached;
-  MLTACG_Node(Function *f)
-  {
-    func = f;
-    reduced = false;
-    reached = false;
-    if (!f->isDeclaration() && depInfo)
-    {
-      pdt = new llvm::PostDominatorTree(*f);
-      cdg = new pdg::ControlDependencyGraph2(f, pdt);
-    }
-  }
+  uint32_t id;
+  MLTACG_Node(Function *f, uint32_t id) : func(f), id(id) {}
 
-  void reduceCallSite(CallInst *cs)
+  ~MLTACG_Node()
   {
-    for (MLTACG_Edge *edge : out_edges)
-    {
-      if (edge->callSite == cs)
-      {
-        // if (!edge->dst->func->isIntrinsic() && !edge->dst->func->isDeclaration())
-        // errs() << formatv("reduce edge:{0}-->{1}\n", edge->src->func->getName(), edge->dst->func->getName());
-        edge->reduced = true;
-      }
-    }
+    delete cdg;
+    delete pdt;
   }
 
-  // 检查并更新与该node相关的状态，返回false表明其不可能影响children节点的状态
-  // 返回true则表明其可能会影响
-  bool selfCheck()
+  // 该call ins的cdg path中最短的长度，path本身不保留
+  uint64_t minDep(Instruction *ins) const
   {
-    if (reduced)
-      return false;
-
-    bool needToReduce = true;
-    for (MLTACG_Edge *edge : in_edges)
+    uint64_t minControlDepNode = UINT64_MAX;
+    if (cdg == nullptr)
+      return minControlDepNode;
+    auto it = minDepMap.find(ins);
+    if (it != minDepMap.end())
+      return it->second;
+
+    pathVector paths;
+    cdg->getRDep(ins, paths);
+    for (const std::vector<llvm::Instruction *> &path : paths)
     {
-      if (edge->reduced == false)
-      {
-        needToReduce = false;
-        break;
-      }
-    }
-    if (needToReduce)
-    {
-      reduced = true;
-
-      for (MLTACG_Edge *edge : out_edges)
-      {
-        edge->reduced = true;
-      }
-      return true;
+      if (path.size() < minControlDepNode)
+        minControlDepNode = path.size();
     }
-    return false;
-  }
-
-  ~MLTACG_Node()
-  {
-    delete cdg;
-    delete pdt;
+    minDepMap[ins] = minControlDepNode;
+    return minControlDepNode;
   }
 
   bool isCloned()
@@ -155,31 +175,86 @@ class MLTACGDOTInfo
   Module *M;
   GlobalContext *ctx;
 
+  // 多个module中同名且没有定义的函数共用一个node
+  map<StringRef, Function *> externDecls;
+  DenseMap<Function *, uint32_t> func2node;
+
+  // 出边：node i的出边为edges[outBegin[i], outBegin[i+1])
+  vector<uint32_t> outBegin;
+  // 入边：node i的入边下标为inEdges[inBegin[i], inBegin[i+1])
+  vector<uint32_t> inBegin;
+  vector<uint32_t> inEdges;
+  // 同一call指令对应的边在edges中连续存放
+  DenseMap<CallInst *, pair<uint32_t, uint32_t>> callSiteEdges;
+
 public:
-  set<MLTACG_Node *> nodes;
-  set<MLTACG_Edge *> edges;
-  MLTACG_Node *root;
-  map<CallInst *, MLTACG_Edge *> inst2edges;
+  vector<MLTACG_Node *> nodes;
+  vector<MLTACG_Edge> edges;
+  MLTACG_Node *root = nullptr;
 
-  map<Function *, MLTACG_Node *> func2node;
+  BitVector nodeReduced;
+  BitVector nodeReached;
+  BitVector edgeReduced;
+  BitVector edgeReached;
+
+  // provenance，仅在-provenance时记录
+  vector<uint8_t> edgeCause;
+  vector<Instruction *> edgeDecider;
 
   MLTACGDOTInfo(Module *M, GlobalContext *ctx) : M(M), ctx(ctx)
   {
-    for (auto &func : *M)
+    for (auto &mp : ctx->Modules)
+      for (auto &func : *mp.first)
+      {
+        getNode(&func);
+      }
+
+    // 按id顺序处理，新加入的callee node排在后面，因此edges天然按src有序
+    for (uint32_t id = 0; id < nodes.size(); id++)
+    {
+      outBegin.push_back(edges.size());
+      addCallEdges(nodes[id]);
+    }
+    outBegin.push_back(edges.size());
+    buildInEdges();
+
+    nodeReduced.resize(nodes.size());
+    nodeReached.resize(nodes.size());
+    edgeReduced.resize(edges.size());
+    edgeReached.resize(edges.size());
+    if (provenance)
     {
-      getNode(&func);
+      edgeCause.assign(edges.size(), NotReduced);
+      edgeDecider.assign(edges.size(), nullptr);
     }
   }
 
+  // 声明通过GlobalFuncMap对应到其他module中的定义，与link后的module保持一致
+  Function *resolve(Function *func)
+  {
+    if (!func->isDeclaration())
+      return func;
+    auto it = ctx->GlobalFuncMap.find(func->getGUID());
+    if (it != ctx->GlobalFuncMap.end() && it->second)
+      return it->second;
+    return externDecls.insert({func->getName(), func}).first->second;
+  }
+
   MLTACG_Node *getNode(Function *func)
   {
-    if (func2node.find(func) != func2node.end())
-      return func2node[func];
-    auto node = new MLTACG_Node(func);
-    nodes.insert(node);
-    func2node[func] = node;
+    func = resolve(func);
+    auto it = func2node.find(func);
+    if (it != func2node.end())
+      return nodes[it->second];
+    auto node = new MLTACG_Node(func, nodes.size());
+    func2node[func] = node->id;
+    nodes.push_back(node);
+    return node;
+  }
 
-    for (auto &bb : *func)
+  void addCallEdges(MLTACG_Node *node)
+  {
+    for (auto &bb : *node->func)
       for (auto &ins : bb)
         if (auto ci = dyn_cast<CallInst>(&ins))
         {
@@ -187,21 +262,111 @@ public:
           if (ctx->Callees.find(ci) == ctx->Callees.end())
             continue;
 
+          uint32_t first = edges.size();
           for (auto f : ctx->Callees[ci])
           {
             MLTACG_Node *childNode = getNode(f);
-            MLTACG_Edge *newE = new MLTACG_Edge(node, childNode, ci);
-            edges.insert(newE);
-            node->out_edges.insert(newE);
-            childNode->in_edges.insert(newE);
-            if (depInfo)
-              node->callMap[childNode].insert(ci);
+            edges.emplace_back(node->id, childNode->id, ci);
           }
-          if (depInfo)
-            node->cdg->getRDep(ci, node->pathMap[ci]);
+          callSiteEdges[ci] = {first, (uint32_t)edges.size()};
         }
+  }
 
-    return node;
+  // 构建所有reached node的pdt和cdg，每个node只构建一次。各函数的cdg互不依赖，在线程池中并行构建
+  void buildDepInfo()
+  {
+    vector<MLTACG_Node *> todo;
+    vector<Function *> funcs;
+    for (unsigned id : nodeReached.set_bits())
+    {
+      MLTACG_Node *node = nodes[id];
+      if (node->cdg != nullptr || node->func->isDeclaration())
+        continue;
+      todo.push_back(node);
+      funcs.push_back(node->func);
+    }
+    std::unique_ptr<pdg::DependencyGraphCache> cache;
+    if (!depCacheDir.empty())
+      cache.reset(new pdg::DependencyGraphCache(depCacheDir));
+    vector<pdg::FunctionDependencies> deps = pdg::buildDependencyGraphs(funcs, false, numThreads, cache.get());
+    for (size_t i = 0; i < todo.size(); i++)
+    {
+      MLTACG_Node *node = todo[i];
+      node->pdt = deps[i].PDT.release();
+      node->cdg = deps[i].CDG.release();
+      for (const MLTACG_Edge &edge : outEdges(node->id))
+      {
+        node->callMap[nodes[edge.dst]].insert(edge.callSite);
+      }
+    }
+  }
+
+  void buildInEdges()
+  {
+    inBegin.assign(nodes.size() + 1, 0);
+    for (const MLTACG_Edge &e : edges)
+      inBegin[e.dst + 1]++;
+    for (size_t i = 0; i < nodes.size(); i++)
+      inBegin[i + 1] += inBegin[i];
+    inEdges.resize(edges.size());
+    vector<uint32_t> pos(inBegin.begin(), inBegin.end() - 1);
+    for (uint32_t i = 0; i < edges.size(); i++)
+      inEdges[pos[edges[i].dst]++] = i;
+  }
+
+  ArrayRef<MLTACG_Edge> outEdges(uint32_t id) const
+  {
+    return makeArrayRef(edges.data() + outBegin[id], edges.data() + outBegin[id + 1]);
+  }
+
+  uint32_t edgeId(const MLTACG_Edge &e) const
+  {
+    return &e - edges.data();
+  }
+
+  ArrayRef<uint32_t> inEdgeIds(uint32_t id) const
+  {
+    return makeArrayRef(inEdges.data() + inBegin[id], inEdges.data() + inBegin[id + 1]);
+  }
+
+  void reduceCallSite(CallInst *cs, uint8_t cause = NotReduced, Instruction *decider = nullptr)
+  {
+    auto it = callSiteEdges.find(cs);
+    if (it == callSiteEdges.end())
+      return;
+    // if (!edge->dst->func->isIntrinsic() && !edge->dst->func->isDeclaration())
+    // errs() << formatv("reduce edge:{0}-->{1}\n", edge->src->func->getName(), edge->dst->func->getName());
+    setReduced(it->second.first, it->second.second, cause, decider);
+  }
+
+  // 将[begin, end)的边标记为reduced，已经reduced的边保留最初的原因
+  void setReduced(uint32_t begin, uint32_t end, uint8_t cause, Instruction *decider)
+  {
+    if (provenance)
+      for (uint32_t e = begin; e < end; e++)
+        if (!edgeReduced[e])
+        {
+          edgeCause[e] = cause;
+          edgeDecider[e] = decider;
+        }
+    edgeReduced.set(begin, end);
+  }
+
+  // 检查并更新与该node相关的状态，返回false表明其不可能影响children节点的状态
+  // 返回true则表明其可能会影响
+  bool selfCheck(uint32_t id)
+  {
+    if (nodeReduced[id])
+      return false;
+
+    for (uint32_t e : inEdgeIds(id))
+      if (!edgeReduced[e])
+        return false;
+
+    nodeReduced.set(id);
+    // 没有in边的函数并非因caller被reduce而不可达
+    setReduced(outBegin[id], outBegin[id + 1], inEdgeIds(id).empty() ? Uncalled : CallerReduced, nullptr);
+    return true;
   }
 
   void updateReduced()
@@ -210,30 +375,29 @@ public:
     除main函数外，如果某个函数的in边不存在或者全部被reduced，则reduced该节点,
     之后我们检查其对其他node的影响
      */
-    vector<MLTACG_Node *> workList;
+    vector<uint32_t> workList;
     for (MLTACG_Node *node : nodes)
     {
       if (node == root)
         continue;
-      if (node->selfCheck())
+      if (selfCheck(node->id))
       {
-        workList.push_back(node);
+        workList.push_back(node->id);
         // errs()<<node->func->getName()<<"\n";
       }
     }
     while (!workList.empty())
     {
-      MLTACG_Node *nodeToCheck = workList.back();
+      uint32_t nodeToCheck = workList.back();
       workList.pop_back();
 
-      for (MLTACG_Edge *e : nodeToCheck->out_edges)
+      for (const MLTACG_Edge &e : outEdges(nodeToCheck))
       {
-        MLTACG_Node *next = e->dst;
         // 预防一手
-        if (next == root)
+        if (nodes[e.dst] == root)
           continue;
-        if (e->dst->selfCheck())
-          workList.push_back(e->dst);
+        if (selfCheck(e.dst))
+          workList.push_back(e.dst);
       }
     }
   }
@@ -241,106 +405,578 @@ public:
   void printTotalInfo()
   {
     uint64_t totalBugs = 0;
-    for (MLTACG_Node *node : MI->nodes)
+    for (MLTACG_Node *node : nodes)
     {
       if (node->isBug())
         totalBugs++;
     }
-    errs() << formatv("total: nodes {0},edges {1},bugs {2}\n", MI->nodes.size(), MI->edges.size(), totalBugs);
+    errs() << formatv("total: nodes {0},edges {1},bugs {2}\n", nodes.size(), edges.size(), totalBugs);
   }
 
   void printReachedInfo()
   {
     //reset ReachedInfo
-    for (MLTACG_Node *node : nodes)
-    {
-      node->reached = false;
-    }
-
-    for (MLTACG_Edge *edge : edges)
-    {
-      edge->reached = false;
-    }
+    nodeReached.reset();
+    edgeReached.reset();
 
     //update ReachedInfo
     Function *mainF = M->getFunction("main");
     root = getNode(mainF);
-    set<MLTACG_Node *> reachSet;
-    function<void(MLTACG_Node *)> tr = [&](MLTACG_Node *node)
+    // 显式栈代替递归，避免过深的调用链导致栈溢出
+    vector<uint32_t> stack{root->id};
+    nodeReached.set(root->id);
+    while (!stack.empty())
     {
-      reachSet.insert(node);
-      node->reached = true;
-      for (MLTACG_Edge *edge : node->out_edges)
+      uint32_t id = stack.back();
+      stack.pop_back();
+      for (const MLTACG_Edge &edge : outEdges(id))
       {
-        if (edge->reduced)
+        uint32_t e = edgeId(edge);
+        if (edgeReduced[e])
           continue;
 
-        edge->reached = true;
-        MLTACG_Node *dst = edge->dst;
-        if (reachSet.find(dst) == reachSet.end())
+        edgeReached.set(e);
+        if (!nodeReached[edge.dst])
         {
-          tr(dst);
+          nodeReached.set(edge.dst);
+          stack.push_back(edge.dst);
         }
       }
-    };
-    tr(root);
+    }
+    if (depInfo)
+      buildDepInfo();
 
     //print ReachedInfo
-    uint64_t reachedNodes = 0;
-    uint64_t reachedEdges = 0;
     uint64_t reachedBugs = 0;
+    for (unsigned id : nodeReached.set_bits())
+    {
+      if (nodes[id]->isBug())
+        reachedBugs++;
+    }
 
+    errs() << formatv("reached: nodes {0},edges {1},bug {2}\n", nodeReached.count(), edgeReached.count(), reachedBugs);
+  }
+
+  // 从id出发BFS，pruned为true时不经过reduced的边
+  // parent不为空时记录每个node第一次被访问时经过的边，targets不为空时全部到达后提前结束
+  BitVector reachableFrom(uint32_t id, bool pruned, vector<uint32_t> *parent = nullptr, const BitVector *targets = nullptr)
+  {
+    BitVector reached(nodes.size());
+    size_t remaining = targets ? targets->count() : SIZE_MAX;
+    if (parent)
+      parent->assign(nodes.size(), UINT32_MAX);
+    vector<uint32_t> queue{id};
+    reached.set(id);
+    if (targets && (*targets)[id])
+      remaining--;
+    for (size_t head = 0; head < queue.size() && remaining > 0; head++)
+      for (const MLTACG_Edge &edge : outEdges(queue[head]))
+      {
+        if (pruned && edgeReduced[edgeId(edge)])
+          continue;
+        if (reached[edge.dst])
+          continue;
+        reached.set(edge.dst);
+        queue.push_back(edge.dst);
+        if (parent)
+          (*parent)[edge.dst] = edgeId(edge);
+        if (targets && (*targets)[edge.dst] && --remaining == 0)
+          break;
+      }
+    return reached;
+  }
+
+  BitVector matchTargets(ArrayRef<GlobPattern> patterns)
+  {
+    BitVector targets(nodes.size());
     for (MLTACG_Node *node : nodes)
+      if (any_of(patterns, [&](const GlobPattern &p)
+                 { return p.match(node->func->getName()); }))
+        targets.set(node->id);
+    return targets;
+  }
+
+  // 对每个可达的目标函数，沿parent输出一条从main出发的调用路径
+  void printWitnesses(ArrayRef<GlobPattern> patterns)
+  {
+    BitVector targets = matchTargets(patterns);
+    vector<uint32_t> parent;
+    BitVector reached = reachableFrom(root->id, true, &parent, &targets);
+    for (unsigned id : targets.set_bits())
     {
-      if (node->reached)
-        reachedNodes++;
-      if (node->reached && node->isBug())
-        reachedBugs++;
+      if (!reached[id])
+        continue;
+      vector<StringRef> path;
+      for (uint32_t cur = id; cur != root->id; cur = edges[parent[cur]].src)
+        path.push_back(nodes[cur]->func->getName());
+      path.push_back(root->func->getName());
+      outs() << "witness " << nodes[id]->func->getName() << ": ";
+      for (auto it = path.rbegin(); it != path.rend(); ++it)
+        outs() << (it == path.rbegin() ? "" : " -> ") << *it;
+      outs() << "\n";
+    }
+  }
+
+  // 对比修剪前后从main出发各目标函数的可达性
+  void printReachDiff(ArrayRef<GlobPattern> patterns)
+  {
+    BitVector targetSet = matchTargets(patterns);
+    BitVector reachO = reachableFrom(root->id, false, nullptr, &targetSet);
+    BitVector reachR = reachableFrom(root->id, true, nullptr, &targetSet);
+
+    uint64_t targets = 0, reachedO = 0, reachedR = 0, changed = 0;
+    for (unsigned id : targetSet.set_bits())
+    {
+      StringRef name = nodes[id]->func->getName();
+      bool o = reachO[id], r = reachR[id];
+      targets++;
+      reachedO += o;
+      reachedR += r;
+      changed += o != r;
+      outs() << formatv("target {0}: original {1},reduced {2}{3}\n", name, o, r, o != r ? ",changed" : "");
+    }
+    outs() << formatv("diff: targets {0},original {1},reduced {2},changed {3}\n", targets, reachedO, reachedR, changed);
+  }
+
+  // 输出每条reduced边的原因、起决定作用的指令以及所在的trimmer特化函数，并按原因汇总
+  void printProvenance(double visitTime, double updateTime)
+  {
+    uint64_t count[NumCauses] = {0};
+    for (unsigned e : edgeReduced.set_bits())
+    {
+      const MLTACG_Edge &edge = edges[e];
+      MLTACG_Node *caller = nodes[edge.src];
+      count[edgeCause[e]]++;
+
+      string decider = "-";
+      if (edgeDecider[e] != nullptr)
+      {
+        string ins;
+        raw_string_ostream SO(ins);
+        edgeDecider[e]->print(SO);
+        decider = BB2label(edgeDecider[e]->getParent()) + ": " + StringRef(SO.str()).trim().str();
+      }
+      outs() << formatv("reduced {0} -> {1}: cause {2},decider {3},clone {4}\n", caller->func->getName(),
+                        nodes[edge.dst]->func->getName(), causeName(edgeCause[e]), decider,
+                        caller->isCloned() ? caller->func->getName() : "-");
+    }
+
+    for (uint8_t cause = FoldedBranch; cause < NumCauses; cause++)
+      outs() << formatv("provenance: cause {0},edges {1}\n", causeName(cause), count[cause]);
+    outs() << formatv("provenance: visit {0:f3}s,update {1:f3}s\n", visitTime, updateTime);
+  }
+
+  // 迭代的Tarjan算法，sccOf[i]为node i所在scc的编号，scc按逆拓扑序编号。
+  // pruned为true时忽略reduced的node和edge
+  uint32_t computeSCCs(bool pruned, vector<uint32_t> &sccOf)
+  {
+    uint32_t n = nodes.size(), next = 0, numSCC = 0;
+    vector<uint32_t> index(n, UINT32_MAX), low(n), stack;
+    BitVector onStack(n);
+    vector<pair<uint32_t, uint32_t>> callStack; // node及下一条待访问的出边
+    sccOf.assign(n, UINT32_MAX);
+
+    for (uint32_t r = 0; r < n; r++)
+    {
+      if (index[r] != UINT32_MAX || (pruned && nodeReduced[r]))
+        continue;
+      index[r] = low[r] = next++;
+      stack.push_back(r);
+      onStack.set(r);
+      callStack.push_back({r, outBegin[r]});
+      while (!callStack.empty())
+      {
+        uint32_t v = callStack.back().first;
+        if (callStack.back().second < outBegin[v + 1])
+        {
+          uint32_t e = callStack.back().second++;
+          if (pruned && edgeReduced[e])
+            continue;
+          uint32_t w = edges[e].dst;
+          if (index[w] == UINT32_MAX)
+          {
+            index[w] = low[w] = next++;
+            stack.push_back(w);
+            onStack.set(w);
+            callStack.push_back({w, outBegin[w]});
+          }
+          else if (onStack[w])
+            low[v] = std::min(low[v], index[w]);
+          continue;
+        }
+
+        callStack.pop_back();
+        if (!callStack.empty())
+        {
+          uint32_t u = callStack.back().first;
+          low[u] = std::min(low[u], low[v]);
+        }
+        if (low[v] != index[v])
+          continue;
+        uint32_t w;
+        do
+        {
+          w = stack.back();
+          stack.pop_back();
+          onStack.reset(w);
+          sccOf[w] = numSCC;
+        } while (w != v);
+        numSCC++;
+      }
+    }
+    return numSCC;
+  }
+
+  // 原始或修剪后的图的统计信息：规模、scc大小分布、直接/间接call的扇出、传递可达数最多的函数
+  json::Object graphStats(bool pruned, unsigned topK)
+  {
+    auto edgeAlive = [&](uint32_t e)
+    { return !pruned || !edgeReduced[e]; };
+
+    uint64_t numNodes = 0, numEdges = 0;
+    for (uint32_t id = 0; id < nodes.size(); id++)
+      numNodes += !pruned || !nodeReduced[id];
+    for (uint32_t e = 0; e < edges.size(); e++)
+      numEdges += edgeAlive(e);
+
+    // scc大小分布
+    vector<uint32_t> sccOf;
+    uint32_t numSCC = computeSCCs(pruned, sccOf);
+    vector<uint64_t> sccSize(numSCC);
+    for (uint32_t id = 0; id < nodes.size(); id++)
+      if (sccOf[id] != UINT32_MAX)
+        sccSize[sccOf[id]]++;
+    std::map<uint64_t, uint64_t> sizeHist;
+    for (uint64_t size : sccSize)
+      sizeHist[size]++;
+    json::Object sccDist;
+    for (auto &it : sizeHist)
+      sccDist[to_string(it.first)] = (int64_t)it.second;
+
+    // 同一call ins的边连续存放，按call ins统计扇出
+    struct FanOut
+    {
+      uint64_t callSites = 0, targets = 0, max = 0;
+    } direct, indirect;
+    vector<pair<uint64_t, uint32_t>> indirectSites; // 扇出及第一条边
+    for (uint32_t begin = 0, end; begin < edges.size(); begin = end)
+    {
+      uint64_t targets = 0;
+      for (end = begin; end < edges.size() && edges[end].callSite == edges[begin].callSite; end++)
+        targets += edgeAlive(end);
+      if (targets == 0)
+        continue;
+      bool isIndirect = edges[begin].callSite->isIndirectCall();
+      FanOut &f = isIndirect ? indirect : direct;
+      f.callSites++;
+      f.targets += targets;
+      f.max = std::max(f.max, targets);
+      if (isIndirect)
+        indirectSites.push_back({targets, begin});
+    }
+    auto fanOutJSON = [](const FanOut &f)
+    {
+      return json::Object{{"callSites", (int64_t)f.callSites},
+                          {"targets", (int64_t)f.targets},
+                          {"max", (int64_t)f.max},
+                          {"mean", f.callSites ? (double)f.targets / f.callSites : 0.0}};
+    };
+
+    size_t k = std::min<size_t>(topK, indirectSites.size());
+    partial_sort(indirectSites.begin(), indirectSites.begin() + k, indirectSites.end(),
+                 [](const pair<uint64_t, uint32_t> &a, const pair<uint64_t, uint32_t> &b)
+                 { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+    json::Array topIndirect;
+    for (size_t i = 0; i < k; i++)
+    {
+      const MLTACG_Edge &edge = edges[indirectSites[i].second];
+      json::Object site{{"caller", nodes[edge.src]->func->getName()},
+                        {"targets", (int64_t)indirectSites[i].first}};
+      if (const DebugLoc &loc = edge.callSite->getDebugLoc())
+        site["loc"] = formatv("{0}:{1}", loc->getFilename(), loc.getLine()).str();
+      topIndirect.push_back(std::move(site));
     }
 
-    for (MLTACG_Edge *edge : edges)
+    // 传递可达的node数：scc按逆拓扑序编号，后继scc的可达集合总是先算好。
+    // 集合为稀疏表示，被所有前驱scc合并后即释放，不保存完整的传递闭包
+    vector<SparseBitVector<>> sccReach(numSCC);
+    vector<vector<uint32_t>> sccNodes(numSCC);
+    vector<uint32_t> pendingIn(numSCC); // 尚未合并该scc集合的跨scc边数
+    for (uint32_t id = 0; id < nodes.size(); id++)
+    {
+      if (sccOf[id] == UINT32_MAX)
+        continue;
+      sccNodes[sccOf[id]].push_back(id);
+      for (const MLTACG_Edge &edge : outEdges(id))
+        if (edgeAlive(edgeId(edge)) && sccOf[edge.dst] != sccOf[id])
+          pendingIn[sccOf[edge.dst]]++;
+    }
+    vector<uint64_t> reach(numSCC);
+    for (uint32_t scc = 0; scc < numSCC; scc++)
     {
-      if (edge->reached)
-        reachedEdges++;
+      SparseBitVector<> &r = sccReach[scc];
+      r.set(scc);
+      for (uint32_t id : sccNodes[scc])
+        for (const MLTACG_Edge &edge : outEdges(id))
+        {
+          uint32_t succ = sccOf[edge.dst];
+          if (!edgeAlive(edgeId(edge)) || succ == scc)
+            continue;
+          r |= sccReach[succ];
+          if (--pendingIn[succ] == 0)
+            sccReach[succ].clear();
+        }
+      for (unsigned s : r)
+        reach[scc] += sccSize[s];
+      if (pendingIn[scc] == 0)
+        r.clear();
     }
+    vector<uint32_t> byReach;
+    for (uint32_t id = 0; id < nodes.size(); id++)
+      if (sccOf[id] != UINT32_MAX)
+        byReach.push_back(id);
+    k = std::min<size_t>(topK, byReach.size());
+    partial_sort(byReach.begin(), byReach.begin() + k, byReach.end(),
+                 [&](uint32_t a, uint32_t b)
+                 { return reach[sccOf[a]] != reach[sccOf[b]] ? reach[sccOf[a]] > reach[sccOf[b]] : a < b; });
+    json::Array topReach;
+    for (size_t i = 0; i < k; i++)
+      topReach.push_back(json::Object{{"name", nodes[byReach[i]]->func->getName()},
+                                      {"reach", (int64_t)reach[sccOf[byReach[i]]]}});
+
+    return json::Object{{"nodes", (int64_t)numNodes},
+                        {"edges", (int64_t)numEdges},
+                        {"sccs", (int64_t)numSCC},
+                        {"largestSCC", (int64_t)(sizeHist.empty() ? 0 : sizeHist.rbegin()->first)},
+                        {"sccSizes", std::move(sccDist)},
+                        {"direct", fanOutJSON(direct)},
+                        {"indirect", fanOutJSON(indirect)},
+                        {"topIndirectCallSites", std::move(topIndirect)},
+                        {"topReach", std::move(topReach)}};
+  }
 
-    errs() << formatv("reached: nodes {0},edges {1},bug {2}\n", reachedNodes, reachedEdges, reachedBugs);
+  void printStats(unsigned topK)
+  {
+    json::Object stats{{"original", graphStats(false, topK)},
+                       {"reduced", graphStats(true, topK)}};
+    outs() << formatv("{0:2}", json::Value(std::move(stats))) << "\n";
   }
 
   void dump(string fileName)
   {
-    WriteGraph(this, "", false, "", fileName);
+    if (outputFormat == DotFormat)
+    {
+      WriteGraph(this, "", false, "", fileName);
+      return;
+    }
+
+    std::error_code ec;
+    raw_fd_ostream OS(fileName, ec, outputFormat == BinaryFormat ? sys::fs::OF_None : sys::fs::OF_Text);
+    if (ec)
+    {
+      errs() << formatv("Error opening {0}: {1}\n", fileName, ec.message());
+      return;
+    }
+    errs() << "Writing '" << fileName << "'... ";
+    if (outputFormat == BinaryFormat)
+      dumpBinary(OS);
+    else
+      dumpJSONLines(OS);
+    errs() << " done. \n";
   }
 
-  void prun()
+  /*
+  binary格式，整数均为小端:
+    "MLTACG\0\1", u32 nodes, u32 edges, u32 字符串表长度, 字符串表(以\0结尾的函数名)
+    node: u32 名字在字符串表中的偏移, u8 flags
+    edge: u32 src, u32 dst, u32 call site编号, u8 flags
+  edge按src有序，同一call ins的边连续存放且编号相同
+   */
+  enum : uint8_t
+  {
+    NodeAddressTaken = 1,
+    NodeDeclaration = 2,
+    NodeReached = 4,
+    NodeReduced = 8,
+    EdgeIndirect = 1,
+    EdgeReached = 2,
+    EdgeReduced = 4,
+  };
+
+  void dumpBinary(raw_ostream &OS)
   {
-    vector<MLTACG_Edge *> needToRemoveEdges;
-    for (MLTACG_Edge *edge : edges)
+    support::endian::Writer W(OS, support::little);
+    vector<uint32_t> nameOffset;
+    uint32_t strTabSize = 0;
+    for (MLTACG_Node *node : nodes)
     {
-      if (edge->reduced)
-        needToRemoveEdges.push_back(edge);
+      nameOffset.push_back(strTabSize);
+      strTabSize += node->func->getName().size() + 1;
     }
 
-    for (MLTACG_Edge *edge : needToRemoveEdges)
+    OS.write("MLTACG\0\1", 8);
+    W.write<uint32_t>(nodes.size());
+    W.write<uint32_t>(edges.size());
+    W.write<uint32_t>(strTabSize);
+    for (MLTACG_Node *node : nodes)
     {
-      edge->src->out_edges.erase(edge);
-      edge->dst->in_edges.erase(edge);
-      edges.erase(edge);
+      OS << node->func->getName();
+      OS.write('\0');
     }
 
-    vector<MLTACG_Node *> needToRemoveNodes;
     for (MLTACG_Node *node : nodes)
     {
-      if (node->reduced)
-        needToRemoveNodes.push_back(node);
+      W.write<uint32_t>(nameOffset[node->id]);
+      W.write<uint8_t>(nodeFlags(node->id));
     }
 
-    for (MLTACG_Node *node : needToRemoveNodes)
+    uint32_t callSite = 0;
+    for (const MLTACG_Edge &edge : edges)
     {
-      nodes.erase(node);
+      uint32_t e = edgeId(edge);
+      if (e > 0 && edges[e - 1].callSite != edge.callSite)
+        callSite++;
+      W.write<uint32_t>(edge.src);
+      W.write<uint32_t>(edge.dst);
+      W.write<uint32_t>(callSite);
+      W.write<uint8_t>(edgeFlags(e));
     }
   }
 
+  // 每行一个json对象，先输出所有node再输出所有edge
+  void dumpJSONLines(raw_ostream &OS)
+  {
+    for (MLTACG_Node *node : nodes)
+    {
+      json::OStream J(OS);
+      J.object([&]
+               {
+        J.attribute("type", "node");
+        J.attribute("id", node->id);
+        J.attribute("name", node->func->getName());
+        J.attribute("addressTaken", node->func->hasAddressTaken());
+        J.attribute("declaration", node->func->isDeclaration());
+        J.attribute("reached", (bool)nodeReached[node->id]);
+        J.attribute("reduced", (bool)nodeReduced[node->id]); });
+      OS << "\n";
+    }
+
+    uint32_t callSite = 0;
+    for (const MLTACG_Edge &edge : edges)
+    {
+      uint32_t e = edgeId(edge);
+      if (e > 0 && edges[e - 1].callSite != edge.callSite)
+        callSite++;
+      json::OStream J(OS);
+      J.object([&]
+               {
+        J.attribute("type", "edge");
+        J.attribute("src", edge.src);
+        J.attribute("dst", edge.dst);
+        J.attribute("callSite", callSite);
+        J.attribute("indirect", edge.callSite->isIndirectCall());
+        J.attribute("reached", (bool)edgeReached[e]);
+        J.attribute("reduced", (bool)edgeReduced[e]);
+        if (depInfo)
+        {
+          uint64_t minDep = nodes[edge.src]->minDep(edge.callSite);
+          if (minDep != UINT64_MAX)
+            J.attribute("minDep", (int64_t)minDep);
+        } });
+      OS << "\n";
+    }
+  }
+
+  uint8_t nodeFlags(uint32_t id) const
+  {
+    uint8_t flags = 0;
+    if (nodes[id]->func->hasAddressTaken())
+      flags |= NodeAddressTaken;
+    if (nodes[id]->func->isDeclaration())
+      flags |= NodeDeclaration;
+    if (nodeReached[id])
+      flags |= NodeReached;
+    if (nodeReduced[id])
+      flags |= NodeReduced;
+    return flags;
+  }
+
+  uint8_t edgeFlags(uint32_t e) const
+  {
+    uint8_t flags = 0;
+    if (edges[e].callSite->isIndirectCall())
+      flags |= EdgeIndirect;
+    if (edgeReached[e])
+      flags |= EdgeReached;
+    if (edgeReduced[e])
+      flags |= EdgeReduced;
+    return flags;
+  }
+
+  // 一次压缩删去所有reduced的node和edge，并重新分配id
+  void prun()
+  {
+    vector<uint32_t> newId(nodes.size(), UINT32_MAX);
+    vector<MLTACG_Node *> newNodes;
+    for (MLTACG_Node *node : nodes)
+    {
+      if (nodeReduced[node->id])
+      {
+        func2node.erase(node->func);
+        delete node;
+        continue;
+      }
+      newId[node->id] = newNodes.size();
+      node->id = newNodes.size();
+      newNodes.push_back(node);
+    }
+
+    // reached状态随node和edge一起保留
+    BitVector newNodeReached(newNodes.size());
+    for (uint32_t id = 0; id < nodes.size(); id++)
+      if (newId[id] != UINT32_MAX && nodeReached[id])
+        newNodeReached.set(newId[id]);
+
+    vector<MLTACG_Edge> newEdges;
+    BitVector newEdgeReached;
+    vector<uint32_t> newOutBegin;
+    for (uint32_t id = 0; id < nodes.size(); id++)
+    {
+      if (newId[id] == UINT32_MAX)
+        continue;
+      newOutBegin.push_back(newEdges.size());
+      for (const MLTACG_Edge &edge : outEdges(id))
+      {
+        if (edgeReduced[edgeId(edge)])
+          continue;
+        newEdges.emplace_back(newId[edge.src], newId[edge.dst], edge.callSite);
+        newEdgeReached.push_back(edgeReached[edgeId(edge)]);
+      }
+    }
+    newOutBegin.push_back(newEdges.size());
+
+    nodes.swap(newNodes);
+    edges.swap(newEdges);
+    outBegin.swap(newOutBegin);
+    for (MLTACG_Node *node : nodes)
+      func2node[node->func] = node->id;
+    callSiteEdges.clear();
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+      auto &range = callSiteEdges[edges[i].callSite];
+      if (range.second != i)
+        range.first = i;
+      range.second = i + 1;
+    }
+    buildInEdges();
+
+    nodeReduced.clear();
+    nodeReduced.resize(nodes.size());
+    edgeReduced.clear();
+    edgeReduced.resize(edges.size());
+    nodeReached.swap(newNodeReached);
+    edgeReached.swap(newEdgeReached);
+  }
 };
 
 class CGVisitor : public InstVisitor<CGVisitor>
@@ -352,6 +988,10 @@ class CGVisitor : public InstVisitor<CGVisitor>
 public:
   uint64_t Num_unreachBB = 0;
   uint64_t Num_reducedEdge = 0;
+  // 只读IR，不可执行BB中的call ins先收集起来，由调用者合并到MI中
+  vector<ReducedCallSite> reducedCallSites;
+  // 每个被排除的BB第一次被哪条terminator排除
+  DenseMap<BasicBlock *, Instruction *> infeasibleBy;
 
   void getFeasibleSuccessors(Instruction &TI, SmallVectorImpl<bool> &Succs)
   {
@@ -444,10 +1084,11 @@ public:
   void handleUnExecutableBB(BasicBlock &b, MLTACG_Node *node)
   {
     Num_unreachBB++;
+    Instruction *decider = infeasibleBy.lookup(&b);
     for (auto &i : b)
       if (auto ci = dyn_cast<CallInst>(&i))
       {
-        node->reduceCallSite(ci);
+        reducedCallSites.push_back({ci, decider ? FoldedBranch : DeadBlock, decider});
         Num_reducedEdge++;
       }
   }
@@ -461,7 +1102,11 @@ public:
     for (unsigned i = 0, e = SuccFeasible.size(); i != e; ++i)
     {
       if (!SuccFeasible[i])
+      {
+        if (provenance)
+          infeasibleBy.insert({TI.getSuccessor(i), &TI});
         continue;
+      }
 
       BasicBlock *BB = TI.getSuccessor(i);
       if (BBExecutable.find(BB) == BBExecutable.end())
@@ -490,11 +1135,28 @@ public:
       visit(BB->getTerminator());
     }
 
+    // 只能经由被排除的BB到达的BB，沿用排除其前驱的terminator
+    if (provenance)
+    {
+      SmallVector<BasicBlock *, 16> workList;
+      for (auto &b : f->getBasicBlockList())
+        if (BBExecutable.find(&b) == BBExecutable.end() && infeasibleBy.count(&b))
+          workList.push_back(&b);
+      while (!workList.empty())
+      {
+        BasicBlock *BB = workList.pop_back_val();
+        for (BasicBlock *succ : successors(BB))
+          if (BBExecutable.find(succ) == BBExecutable.end() && infeasibleBy.insert({succ, infeasibleBy[BB]}).second)
+            workList.push_back(succ);
+      }
+    }
+
     for (auto &b : f->getBasicBlockList())
       if (BBExecutable.find(&b) == BBExecutable.end())
         handleUnExecutableBB(b, node);
 
     BBExecutable.clear();
+    infeasibleBy.clear();
   }
 
   void printInfo()
@@ -504,6 +1166,177 @@ public:
   }
 };
 
+/*
+以IPSCCP的方式在每个module上运行SCCPSolver，参数与返回值可以在内部函数间传播，
+trimmer特化后的函数中残留的常量参数因此能够继续传播到分支条件上。
+solver证明不可执行的BB中的call ins对应的边被reduce
+ */
+class SCCPPruner
+{
+public:
+  uint64_t Num_unreachBB = 0;
+  uint64_t Num_reducedEdge = 0;
+
+  void run(Module *M)
+  {
+    TargetLibraryInfoImpl TLII(Triple(M->getTargetTriple()));
+    TargetLibraryInfo TLI(TLII);
+    SCCPSolver solver(
+        M->getDataLayout(), [&](Function &) -> const TargetLibraryInfo &
+        { return TLI; },
+        M->getContext());
+
+    // 与runIPSCCP一致，但不构建PredicateInfo，以免向IR中插入ssa.copy。
+    // 参数被跟踪的函数只有在存在可执行的call site时入口才可执行
+    for (Function &f : *M)
+    {
+      if (f.isDeclaration())
+        continue;
+      if (canTrackReturnsInterprocedurally(&f))
+        solver.addTrackedFunction(&f);
+      if (canTrackArgumentsInterprocedurally(&f))
+      {
+        solver.addArgumentTrackedFunction(&f);
+        continue;
+      }
+      solver.markBlockExecutable(&f.front());
+      for (Argument &arg : f.args())
+        solver.markOverdefined(&arg);
+    }
+    for (GlobalVariable &g : M->globals())
+      if (canTrackGlobalVariableInterprocedurally(&g))
+        solver.trackValueOfGlobalVariable(&g);
+
+    bool resolvedUndefs = true;
+    solver.solve();
+    while (resolvedUndefs)
+    {
+      resolvedUndefs = false;
+      for (Function &f : *M)
+        resolvedUndefs |= solver.resolvedUndefsIn(f);
+      if (resolvedUndefs)
+        solver.solve();
+    }
+
+    for (Function &f : *M)
+    {
+      if (f.isDeclaration())
+        continue;
+      // 入口不可执行说明没有可执行的call site，函数内的边归因于caller
+      if (!solver.isBlockExecutable(&f.front()))
+      {
+        for (BasicBlock &b : f)
+          handleUnExecutableBB(b, f.use_empty() ? Uncalled : CallerReduced, nullptr);
+        continue;
+      }
+      DenseMap<BasicBlock *, Instruction *> infeasibleBy;
+      if (provenance)
+        findDeciders(f, solver, infeasibleBy);
+      for (BasicBlock &b : f)
+      {
+        if (solver.isBlockExecutable(&b))
+          continue;
+        Instruction *decider = infeasibleBy.lookup(&b);
+        handleUnExecutableBB(b, decider ? SCCPInfeasible : DeadBlock, decider);
+      }
+    }
+  }
+
+  // 不可执行BB的decider为其可执行前驱的terminator，只能经由不可执行BB到达的BB沿用前驱的decider
+  void findDeciders(Function &f, SCCPSolver &solver, DenseMap<BasicBlock *, Instruction *> &infeasibleBy)
+  {
+    SmallVector<BasicBlock *, 16> workList;
+    for (BasicBlock &b : f)
+    {
+      if (!solver.isBlockExecutable(&b))
+        continue;
+      for (BasicBlock *succ : successors(&b))
+        if (!solver.isBlockExecutable(succ) && infeasibleBy.insert({succ, b.getTerminator()}).second)
+          workList.push_back(succ);
+    }
+    while (!workList.empty())
+    {
+      BasicBlock *BB = workList.pop_back_val();
+      for (BasicBlock *succ : successors(BB))
+        if (!solver.isBlockExecutable(succ) && infeasibleBy.insert({succ, infeasibleBy[BB]}).second)
+          workList.push_back(succ);
+    }
+  }
+
+  void handleUnExecutableBB(BasicBlock &b, uint8_t cause, Instruction *decider)
+  {
+    Num_unreachBB++;
+    for (auto &i : b)
+      if (auto ci = dyn_cast<CallInst>(&i))
+      {
+        MI->reduceCallSite(ci, cause, decider);
+        Num_reducedEdge++;
+      }
+  }
+
+  void printInfo()
+  {
+    errs() << "Number of unreached BB: " << Num_unreachBB << "\n";
+    errs() << "Number of reduced Edge: " << Num_reducedEdge << "\n";
+  }
+};
+
+// 标记不可执行BB中的call边，再传播得到reduced的node
+void reduceUnexecutable(GlobalContext &GlobalCtx)
+{
+  errs() << "pruning...";
+  auto visitStart = chrono::steady_clock::now();
+  if (ipsccp)
+  {
+    SCCPPruner p;
+    for (auto &mp : GlobalCtx.Modules)
+      p.run(mp.first);
+    // p.printInfo();
+  }
+  else
+  {
+    // 每个线程使用独立的CGVisitor，按id交错分配node
+    ThreadPool pool(hardware_concurrency(numThreads));
+    unsigned n = pool.getThreadCount();
+    vector<CGVisitor> visitors(n);
+    for (unsigned t = 0; t < n; t++)
+      pool.async([&, t]
+                 {
+        for (size_t id = t; id < MI->nodes.size(); id += n)
+          visitors[t].run(MI->nodes[id]); });
+    pool.wait();
+    for (CGVisitor &v : visitors)
+    {
+      for (ReducedCallSite &rcs : v.reducedCallSites)
+        MI->reduceCallSite(rcs.callSite, rcs.cause, rcs.decider);
+      // v.printInfo();
+    }
+  }
+  if (noReturnFilter)
+  {
+    // 所有module共用一个filter，调用其他module中错误处理函数的声明也能被识别
+    NoReturnFilter filter([](Function *f)
+                          { return MI->resolve(f); });
+    vector<Module *> modules;
+    for (auto &mp : GlobalCtx.Modules)
+      modules.push_back(mp.first);
+    filter.run(modules);
+    SmallVector<pair<CallInst *, Instruction *>, 16> deadCalls;
+    for (Module *m : modules)
+      for (Function &f : *m)
+        filter.findDeadCalls(f, deadCalls);
+    for (auto &dc : deadCalls)
+      MI->reduceCallSite(dc.first, NoReturnDominated, dc.second);
+  }
+  auto updateStart = chrono::steady_clock::now();
+  MI->updateReduced();
+  auto updateEnd = chrono::steady_clock::now();
+  errs() << "done\n";
+  if (provenance)
+    MI->printProvenance(chrono::duration<double>(updateStart - visitStart).count(),
+                        chrono::duration<double>(updateEnd - updateStart).count());
+}
+
 namespace llvm
 {
   template <>
@@ -511,17 +1344,17 @@ namespace llvm
   {
     typedef MLTACG_Node *NodeRef;
 
-    static MLTACG_Node *GetValuePtr(const MLTACG_Edge *edge) { return edge->dst; }
+    static MLTACG_Node *GetValuePtr(const MLTACG_Edge &edge) { return MI->nodes[edge.dst]; }
 
-    typedef mapped_iterator<set<MLTACG_Edge *>::iterator, decltype(&GetValuePtr)> ChildIteratorType;
+    typedef mapped_iterator<const MLTACG_Edge *, decltype(&GetValuePtr)> ChildIteratorType;
 
     static ChildIteratorType child_begin(NodeRef node)
     {
-      return ChildIteratorType(node->out_edges.begin(), GetValuePtr);
+      return ChildIteratorType(MI->outEdges(node->id).begin(), GetValuePtr);
     }
     static ChildIteratorType child_end(NodeRef node)
     {
-      return ChildIteratorType(node->out_edges.end(), GetValuePtr);
+      return ChildIteratorType(MI->outEdges(node->id).end(), GetValuePtr);
     }
 
     typedef decltype(MLTACGDOTInfo::nodes.begin()) nodes_iterator;
@@ -563,7 +1396,8 @@ namespace llvm
 
     static std::string getEdgeAttributes(const MLTACG_Node *Node, llvm::GraphTraits<MLTACGDOTInfo *>::ChildIteratorType c, const MLTACGDOTInfo *CGInfo)
     {
-      if (depInfo)
+      // 未被访问到的node没有构建depInfo
+      if (depInfo && Node->cdg != nullptr)
       {
         const std::set<Instruction *> &callerSet = Node->callMap.at(*c);
         uint64_t instForChild = callerSet.size();
@@ -571,12 +1405,9 @@ namespace llvm
 
         for (Instruction *ins : callerSet)
         {
-          const MLTACG_Node::pathVector &paths = Node->pathMap.at(ins);
-          for (const std::vector<llvm::Instruction *> &path : paths)
-          {
-            if (path.size() < minControlDepNode)
-              minControlDepNode = path.size();
-          }
+          uint64_t minDep = Node->minDep(ins);
+          if (minDep < minControlDepNode)
+            minControlDepNode = minDep;
         }
         return llvm::formatv("label=\"instC={0},minDep={1}\"", instForChild, minControlDepNode);
       }
@@ -592,46 +1423,83 @@ namespace llvm
 int main(int argc, char **argv)
 {
   cl::ParseCommandLineOptions(argc, argv, "Dump call graph");
-  LLVMContext ctxs;
   SMDiagnostic Err;
-  unique_ptr<Module> mP;
-  mP = parseIRFile(libPath, Err, ctxs);
-  Module *module = mP.get();
+  GlobalContext GlobalCtx;
 
-  if (module == nullptr)
+  // 每个module使用独立的LLVMContext，避免同名struct被重命名而影响MLTA的类型hash
+  vector<std::string> inputs{libPath};
+  inputs.insert(inputs.end(), libModules.begin(), libModules.end());
+  for (auto &input : inputs)
   {
-    outs() << Err.getMessage() << "\n";
-    return -1;
+    LLVMContext *LLVMCtx = new LLVMContext();
+    unique_ptr<Module> mP = parseIRFile(input, Err, *LLVMCtx);
+    if (mP == nullptr)
+    {
+      outs() << Err.getMessage() << "\n";
+      return -1;
+    }
+    Module *module = mP.release();
+    StringRef MName = StringRef(strdup(input.data()));
+    GlobalCtx.Modules.push_back(std::make_pair(module, MName));
+    GlobalCtx.ModuleMaps[module] = MName;
   }
-  StringRef MName = StringRef(strdup(libPath.data()));
-  GlobalContext GlobalCtx;
-  GlobalCtx.Modules.push_back(std::make_pair(module, MName));
-  GlobalCtx.ModuleMaps[module] = MName;
+  Module *module = GlobalCtx.Modules.front().first;
 
   CallGraphPass CGPass(&GlobalCtx);
   CGPass.run(GlobalCtx.Modules);
+  if (mltaStats)
+    CGPass.printTableStats(errs());
   MI = new MLTACGDOTInfo(module, &GlobalCtx);
 
+  vector<GlobPattern> patterns;
+  if (diffTargets.empty())
+    diffTargets.push_back("magma_bug*");
+  for (auto &t : diffTargets)
+  {
+    auto pattern = GlobPattern::create(t);
+    if (!pattern)
+    {
+      errs() << toString(pattern.takeError()) << "\n";
+      return -1;
+    }
+    patterns.push_back(std::move(*pattern));
+  }
+
   MI->printTotalInfo();
-  if (reduceCG)
+  if (diffCG || cgStats)
   {
+    // 不做压缩，原始图即忽略reduced标记的同一张图
     MI->printReachedInfo();
-    errs()<< "pruning...";
-    CGVisitor v;
-    for (MLTACG_Node *node : MI->nodes)
+    reduceUnexecutable(GlobalCtx);
+    MI->printReachedInfo();
+    if (diffCG)
+      MI->printReachDiff(patterns);
+    if (cgStats)
+      MI->printStats(statsTop);
+    if (witness)
+      MI->printWitnesses(patterns);
+    // 同时指定-r时在同一次运行中输出修剪后的图
+    if (reduceCG)
     {
-      v.run(node);
+      MI->prun();
+      MI->dump(OutputFilename.data());
     }
-    // v.printInfo();
-    MI->updateReduced();
-    errs()<< "done\n";
+  }
+  else if (reduceCG)
+  {
+    MI->printReachedInfo();
+    reduceUnexecutable(GlobalCtx);
     MI->printReachedInfo();
+    if (witness)
+      MI->printWitnesses(patterns);
     MI->prun();
     MI->dump(OutputFilename.data());
   }
   else
   {
     MI->printReachedInfo();
+    if (witness)
+      MI->printWitnesses(patterns);
     MI->dump(OutputFilename.data());
   }
   // 实际上，reducedEdge还应该包括在constant propation中由indirect call转变为direct call减少的边
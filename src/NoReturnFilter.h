@@ -0,0 +1,146 @@
+#ifndef _NORETURN_FILTER_H
+#define _NORETURN_FILTER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+/*
+cgd与CGDumper-svf共用的call过滤：
+被noreturn调用支配的call永远不会执行。除了带noreturn属性的函数外，
+所有ret都被noreturn调用支配（或者没有ret）的函数也被视为noreturn，
+例如包装了exit/abort的错误处理函数。每个函数的DominatorTree只构建一次。
+未link的多个module一起分析时，resolve将声明对应到其他module中的定义。
+只有call作为decider：invoke的unwind目标在callee抛出异常时仍然可达
+ */
+class NoReturnFilter
+{
+  llvm::DenseMap<llvm::Function *, std::unique_ptr<llvm::DominatorTree>> DTs;
+  llvm::SmallPtrSet<const llvm::Function *, 16> noReturnFuncs;
+  std::function<llvm::Function *(llvm::Function *)> resolve;
+
+public:
+  explicit NoReturnFilter(std::function<llvm::Function *(llvm::Function *)> resolve = nullptr)
+      : resolve(std::move(resolve)) {}
+
+  llvm::DominatorTree &getDT(llvm::Function &f)
+  {
+    auto &DT = DTs[&f];
+    if (!DT)
+      DT.reset(new llvm::DominatorTree(f));
+    return *DT;
+  }
+
+  bool isNoReturnCall(const llvm::Instruction &I) const
+  {
+    auto ci = llvm::dyn_cast<llvm::CallInst>(&I);
+    if (ci == nullptr)
+      return false;
+    if (ci->doesNotReturn())
+      return true;
+    llvm::Function *callee = ci->getCalledFunction();
+    if (callee == nullptr)
+      return false;
+    if (resolve)
+      callee = resolve(callee);
+    return callee->doesNotReturn() || noReturnFuncs.count(callee);
+  }
+
+  // 迭代到不动点，找出所有不会返回的函数
+  void run(llvm::ArrayRef<llvm::Module *> modules)
+  {
+    bool changed = true;
+    while (changed)
+    {
+      changed = false;
+      for (llvm::Module *M : modules)
+        for (llvm::Function &f : *M)
+        {
+          if (f.isDeclaration() || noReturnFuncs.count(&f))
+            continue;
+          if (!canReturn(f))
+          {
+            noReturnFuncs.insert(&f);
+            changed = true;
+          }
+        }
+    }
+  }
+
+  void run(llvm::Module &M) { run(llvm::ArrayRef<llvm::Module *>(&M)); }
+
+  bool canReturn(llvm::Function &f)
+  {
+    llvm::DenseMap<llvm::BasicBlock *, llvm::Instruction *> deciders;
+    findDeciders(f, deciders);
+    for (llvm::BasicBlock &b : f)
+    {
+      if (!llvm::isa<llvm::ReturnInst>(b.getTerminator()) || deciders.count(&b))
+        continue;
+      if (llvm::none_of(b, [&](llvm::Instruction &i)
+                        { return isNoReturnCall(i); }))
+        return true;
+    }
+    return false;
+  }
+
+  // 收集f中被noreturn调用支配的call，以及支配它的noreturn调用
+  void findDeadCalls(llvm::Function &f, llvm::SmallVectorImpl<std::pair<llvm::CallInst *, llvm::Instruction *>> &deadCalls)
+  {
+    if (f.isDeclaration())
+      return;
+    llvm::DenseMap<llvm::BasicBlock *, llvm::Instruction *> deciders;
+    findDeciders(f, deciders);
+    for (llvm::BasicBlock &b : f)
+    {
+      llvm::Instruction *decider = deciders.lookup(&b);
+      for (llvm::Instruction &i : b)
+      {
+        if (decider != nullptr)
+          if (auto ci = llvm::dyn_cast<llvm::CallInst>(&i))
+            deadCalls.push_back({ci, decider});
+        if (decider == nullptr && isNoReturnCall(i))
+          decider = &i;
+      }
+    }
+  }
+
+private:
+  // 对于被noreturn调用严格支配的BB，记录支配它的第一个noreturn调用。
+  // 沿支配树前序遍历，BB继承其idom的结果，或者idom中的noreturn调用
+  void findDeciders(llvm::Function &f, llvm::DenseMap<llvm::BasicBlock *, llvm::Instruction *> &deciders)
+  {
+    llvm::DominatorTree &DT = getDT(f);
+    llvm::SmallVector<llvm::DomTreeNode *, 16> workList{DT.getRootNode()};
+    while (!workList.empty())
+    {
+      llvm::DomTreeNode *node = workList.pop_back_val();
+      llvm::BasicBlock *BB = node->getBlock();
+      llvm::Instruction *decider = deciders.lookup(BB);
+      if (decider == nullptr)
+        for (llvm::Instruction &i : *BB)
+          if (isNoReturnCall(i))
+          {
+            decider = &i;
+            break;
+          }
+      for (llvm::DomTreeNode *child : node->children())
+      {
+        if (decider != nullptr)
+          deciders[child->getBlock()] = decider;
+        workList.push_back(child);
+      }
+    }
+  }
+};
+
+#endif
@@ -4,6 +4,9 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/ValueMap.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/ADT/StringSet.h>
 #include <stack>
 
 #include "Util/Options.h"
@@ -44,7 +47,10 @@ using namespace std;
 
 const Option<std::string> mainPath("main", "path to the main bc file", "");
 const Option<std::string> libPath("lib", "path to the library bc file", "");
-const Option<std::string> linkedPath("linked", "path to the linked bc file", "");
+const Option<std::string> linkedPath("linked", "path to the linked bc file, link main and lib in-process if empty", "");
+const Option<std::string> cleanupPasses("cleanup", "pass pipeline run on the in-process linked module",
+                                        "globaldce,function(mem2reg,mergereturn,simplifycfg,lcssa,loop-simplify,"
+                                        "loop-mssa(licm),loop(loop-rotate,indvars,loop-reduce))");
 const Option<std::string> outputPath("o", "path to the linked_csm.bc", "linked_csm.bc");
 
 struct CallSiteSpec;
@@ -104,10 +110,39 @@ struct MemObjSpec
     uint64_t ctx_id;
 };
 
+// main和lib模块中定义的符号，在link之前收集，之后用于判断函数和全局变量来自哪个模块
+struct ModuleSymbols
+{
+    StringSet<> funcDefs;
+    StringSet<> globalVars;
+
+    void collect(Module &m)
+    {
+        for (auto &f : m)
+            if (!f.isDeclaration())
+                funcDefs.insert(f.getName());
+        // 与Module::getGlobalVariable一致，不考虑internal的全局变量
+        for (auto &gv : m.globals())
+            if (!gv.hasLocalLinkage())
+                globalVars.insert(gv.getName());
+    }
+
+    bool definesFunc(StringRef name) const
+    {
+        return funcDefs.count(name);
+    }
+
+    bool hasGlobal(StringRef name) const
+    {
+        return globalVars.count(name);
+    }
+};
+
 LLVMModuleSet *svfModuleSet;
 Module *module;
-Module *mainModule;
-Module *libModule;
+ModuleSymbols mainSymbols;
+ModuleSymbols libSymbols;
+vector<std::string> apiFuncNames;
 LLVMContext *ctx;
 BVDataPTAImpl *pta;
 SVFIR *pag;
@@ -253,10 +288,8 @@ void getCallsiteObjs(ArgSpec *as)
             if (memObj->isHeap() || memObj->isStack())
             {
                 auto funcName = dyn_cast<SVFInstruction>(memObj->getValue())->getFunction()->getName();
-                bool inMain =
-                    mainModule->getFunction(funcName) != nullptr && !mainModule->getFunction(funcName)->isDeclaration();
-                bool inLib =
-                    libModule->getFunction(funcName) != nullptr && !libModule->getFunction(funcName)->isDeclaration();
+                bool inMain = mainSymbols.definesFunc(funcName);
+                bool inLib = libSymbols.definesFunc(funcName);
                 if (inMain && !inLib)
                     objSpec.allocType = ObjAllocInMainModule;
                 else if (!inMain && inLib && memObj->isHeap())
@@ -265,8 +298,8 @@ void getCallsiteObjs(ArgSpec *as)
             else if (memObj->isGlobalObj())
             {
                 auto valueName = memObj->getValue()->getName();
-                bool inMain = mainModule->getGlobalVariable(valueName) != nullptr;
-                bool inLib = libModule->getGlobalVariable(valueName) != nullptr;
+                bool inMain = mainSymbols.hasGlobal(valueName);
+                bool inLib = libSymbols.hasGlobal(valueName);
                 if (inMain && !inLib)
                     objSpec.allocType = ObjAllocInMainModule;
                 else if (!inMain && inLib)
@@ -331,20 +364,52 @@ void getCallsiteObjs(ArgSpec *as)
     }
 }
 
-void analysisApiCallSites()
+// 收集main中声明、由lib定义并导出的函数，需在link之前调用
+void collectApiFuncNames(Module &mainModule, Module &libModule)
 {
-    vector<llvm::StringRef> apiFuncNames;
-    for (auto &f : *mainModule)
+    mainSymbols.collect(mainModule);
+    libSymbols.collect(libModule);
+    for (auto &f : mainModule)
         if (f.isDeclaration())
         {
-            auto libFunc = libModule->getFunction(f.getName());
+            auto libFunc = libModule.getFunction(f.getName());
             if (libFunc != nullptr && !libFunc->isDeclaration() && !libFunc->hasInternalLinkage())
             {
-                apiFuncNames.push_back(f.getName());
+                apiFuncNames.push_back(f.getName().str());
             }
         }
+}
 
-    for (auto fName : apiFuncNames)
+// 在进程内完成link及后续的清理pass，取代llvm-link和opt生成的linked模块
+bool linkModules(unique_ptr<Module> &mainModule, unique_ptr<Module> libModule)
+{
+    if (Linker::linkModules(*mainModule, std::move(libModule)))
+        return false;
+
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    PassBuilder PB;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    ModulePassManager MPM;
+    if (auto err = PB.parsePassPipeline(MPM, cleanupPasses()))
+    {
+        errs() << toString(std::move(err)) << "\n";
+        return false;
+    }
+    MPM.run(*mainModule, MAM);
+    return true;
+}
+
+void analysisApiCallSites()
+{
+    for (auto &fName : apiFuncNames)
     {
         // find callsites of apiFunc in linkedModule
         // errs() << "analysis api " << fName << "\n";
@@ -355,10 +420,8 @@ void analysisApiCallSites()
         for (auto inEdge : node->getInEdges())
         {
             auto callerName = inEdge->getSrcNode()->getFunction()->getName();
-            bool inMain =
-                mainModule->getFunction(callerName) != nullptr && !mainModule->getFunction(callerName)->isDeclaration();
-            bool inLib =
-                libModule->getFunction(callerName) != nullptr && !libModule->getFunction(callerName)->isDeclaration();
+            bool inMain = mainSymbols.definesFunc(callerName);
+            bool inLib = libSymbols.definesFunc(callerName);
 
             if (inMain && !inLib)
             {
@@ -1219,13 +1282,33 @@ int main(int argc, char **argv)
     unique_ptr<Module> mP[3];
     mP[0] = parseIRFile(mainPath(), Err, ctxs[0]);
     mP[1] = parseIRFile(libPath(), Err, ctxs[0]);
-    mP[2] = parseIRFile(linkedPath(), Err, ctxs[1]);
 
-    mainModule = mP[0].get();
-    libModule = mP[1].get();
+    if (mP[0] == nullptr || mP[1] == nullptr)
+    {
+        outs() << Err.getMessage() << "\n";
+        return -1;
+    }
+    collectApiFuncNames(*mP[0], *mP[1]);
+
+    if (linkedPath().empty())
+    {
+        // lib被link进main，不再额外保存一份linked模块
+        if (!linkModules(mP[0], std::move(mP[1])))
+        {
+            outs() << "failed to link " << mainPath() << " with " << libPath() << "\n";
+            return -1;
+        }
+        mP[2] = std::move(mP[0]);
+    }
+    else
+    {
+        mP[0].reset();
+        mP[1].reset();
+        mP[2] = parseIRFile(linkedPath(), Err, ctxs[1]);
+    }
     module = mP[2].get();
 
-    if (mainModule == nullptr || libModule == nullptr || module == nullptr)
+    if (module == nullptr)
     {
         outs() << Err.getMessage() << "\n";
         return -1;
@@ -1261,7 +1344,7 @@ int main(int argc, char **argv)
 
     cg = pta->getPTACallGraph();
 
-    StringRef MName = StringRef(linkedPath());
+    StringRef MName = StringRef(linkedPath().empty() ? mainPath() : linkedPath());
     GlobalCtx.Modules.push_back(std::make_pair(module, MName));
     GlobalCtx.ModuleMaps[module] = MName;
 
@@ -0,0 +1,129 @@
+// Tests of NoReturnFilter on small modules parsed from textual IR.
+#define CATCH_CONFIG_MAIN
+// the signal handling of this catch version does not build with newer glibc
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#include "catch2/catch.hpp"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "NoReturnFilter.h"
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace
+{
+std::unique_ptr<Module> parse(LLVMContext &C, const char *ir)
+{
+  SMDiagnostic err;
+  std::unique_ptr<Module> M = parseAssemblyString(ir, err, C);
+  if (!M)
+    FAIL(err.getMessage().str());
+  return M;
+}
+
+// names of the callees of the dead calls in f
+std::set<std::string> deadCallees(NoReturnFilter &filter, Function &f)
+{
+  SmallVector<std::pair<CallInst *, Instruction *>, 4> deadCalls;
+  filter.findDeadCalls(f, deadCalls);
+  std::set<std::string> names;
+  for (auto &dc : deadCalls)
+    names.insert(dc.first->getCalledFunction()->getName().str());
+  return names;
+}
+} // namespace
+
+TEST_CASE("calls after an error wrapper are dead", "[noreturn]")
+{
+  LLVMContext C;
+  std::unique_ptr<Module> M = parse(C, R"(
+declare void @abort() noreturn
+declare void @use()
+
+define void @fail() {
+  call void @abort()
+  ret void
+}
+
+define void @f() {
+  call void @fail()
+  call void @use()
+  ret void
+}
+)");
+  NoReturnFilter filter;
+  filter.run(*M);
+  CHECK(deadCallees(filter, *M->getFunction("f")) == std::set<std::string>{"use"});
+}
+
+TEST_CASE("the unwind destination of an invoke of a noreturn callee is alive", "[noreturn]")
+{
+  LLVMContext C;
+  std::unique_ptr<Module> M = parse(C, R"(
+declare void @throwError() noreturn
+declare void @cleanup()
+declare i32 @__gxx_personality_v0(...)
+
+define void @f() personality i32 (...)* @__gxx_personality_v0 {
+entry:
+  invoke void @throwError() to label %cont unwind label %lpad
+cont:
+  unreachable
+lpad:
+  %lp = landingpad { i8*, i32 } cleanup
+  call void @cleanup()
+  resume { i8*, i32 } %lp
+}
+)");
+  NoReturnFilter filter;
+  filter.run(*M);
+  CHECK(deadCallees(filter, *M->getFunction("f")).empty());
+}
+
+TEST_CASE("error wrappers are resolved across unlinked modules", "[noreturn]")
+{
+  LLVMContext C;
+  std::unique_ptr<Module> main = parse(C, R"(
+declare void @lib_error()
+declare void @use()
+
+define void @f() {
+  call void @lib_error()
+  call void @use()
+  ret void
+}
+)");
+  std::unique_ptr<Module> lib = parse(C, R"(
+declare void @exit(i32) noreturn
+
+define void @lib_error() {
+  call void @exit(i32 1)
+  ret void
+}
+)");
+  std::vector<Module *> modules{main.get(), lib.get()};
+  Function *f = main->getFunction("f");
+
+  SECTION("without a resolver the declaration is opaque")
+  {
+    NoReturnFilter filter;
+    filter.run(modules);
+    CHECK(deadCallees(filter, *f).empty());
+  }
+  SECTION("declarations resolve to their definition")
+  {
+    NoReturnFilter filter([&](Function *decl)
+                          {
+      Function *def = lib->getFunction(decl->getName());
+      return def != nullptr && !def->isDeclaration() ? def : decl; });
+    filter.run(modules);
+    CHECK(deadCallees(filter, *f) == std::set<std::string>{"use"});
+  }
+}
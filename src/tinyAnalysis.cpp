@@ -19,7 +19,8 @@
 
 using namespace llvm;
 
-cl::opt<std::string> libPath(cl::Positional, cl::desc("input bitcode file"));
+cl::list<std::string> libPath(cl::Positional, cl::OneOrMore, cl::desc("input bitcode files"));
+cl::opt<std::string> apiLib("lib", cl::init(""), cl::desc("library bitcode file, its exported functions are taken as the lib api"));
 cl::opt<std::string> action("a", cl::desc("action"));
 cl::opt<std::string> output("o", cl::desc("output path"));
 cl::opt<std::string> strFile("str", cl::init(""), cl::desc("path to lib api string"));
@@ -103,53 +104,84 @@ int main(int argc, char **argv)
     LLVMContext ctxs;
     SMDiagnostic Err;
     std::unique_ptr<Module> mP;
+    std::vector<std::string> apiNames;
 
-    mP = parseIRFile(libPath, Err, ctxs);
-    module = mP.get();
-    std::string apiString;
-    const char *sf = strFile.c_str();
-    const char *lp = libPath.c_str();
-    if (strFile == "")
-    {
-        std::cin >> apiString;
-    }
-    else
-    {
-        std::fstream inFile(strFile);
-        inFile >> apiString;
-    }
-
-    if (module == nullptr || apiString.empty())
+    if (action == "t" && libPath.size() > 1)
     {
         outs() << "param error\n";
         return -1;
     }
-    std::stringstream ss(apiString);
-    std::string item;
 
-    while (std::getline(ss, item, ':'))
+    if (apiLib != "")
     {
-        Function *f = module->getFunction(item);
-        if (f == nullptr)
-            continue;
-        apiFuncs.insert(f);
-        for (User *user : f->users())
+        // 直接从lib中收集导出的函数作为api，多个主模块共用同一份lib
+        std::unique_ptr<Module> libM = parseIRFile(apiLib, Err, ctxs);
+        if (libM == nullptr)
         {
-            if (auto ins = dyn_cast<CallBase>(user))
-                callerFuncs.insert(ins->getFunction());
+            outs() << "param error\n";
+            return -1;
+        }
+        for (Function &f : *libM)
+        {
+            if (!f.isDeclaration() && !f.hasLocalLinkage())
+                apiNames.push_back(f.getName().str());
         }
     }
-
-    if (action == "t")
+    else
     {
-        if (callerFuncs.size() == 1)
-            fastAnalysis(*callerFuncs.begin());
+        std::string apiString;
+        if (strFile == "")
+        {
+            std::cin >> apiString;
+        }
         else
-            errs() << "too many caller func\n";
+        {
+            std::fstream inFile(strFile);
+            inFile >> apiString;
+        }
+        std::stringstream ss(apiString);
+        std::string item;
+        while (std::getline(ss, item, ':'))
+            apiNames.push_back(item);
     }
 
-    if (action == "p")
-        printInfo();
+    for (auto &path : libPath)
+    {
+        mP = parseIRFile(path, Err, ctxs);
+        module = mP.get();
+
+        if (module == nullptr || apiNames.empty())
+        {
+            outs() << "param error\n";
+            return -1;
+        }
+
+        apiFuncs.clear();
+        callerFuncs.clear();
+        for (auto &item : apiNames)
+        {
+            Function *f = module->getFunction(item);
+            if (f == nullptr)
+                continue;
+            apiFuncs.insert(f);
+            for (User *user : f->users())
+            {
+                if (auto ins = dyn_cast<CallBase>(user))
+                    callerFuncs.insert(ins->getFunction());
+            }
+        }
+
+        if (action == "t")
+        {
+            if (callerFuncs.size() == 1)
+                fastAnalysis(*callerFuncs.begin());
+            else
+                errs() << "too many caller func\n";
+        }
+
+        if (action == "p")
+            printInfo();
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -97,11 +97,10 @@ class Target():
             "{}.{}.con.tmp".format(mName, lName)))  # constant模块路径
         self.cgrPath: str = str(workPath.joinpath(
             "{}.{}.cgr.tmp".format(mName, lName)))  # 修剪后callgraph路径
-        self.cgoPath: str = str(workPath.joinpath(
-            "{}.{}.cgo.tmp".format(mName, lName)))  # 修剪前callgraph路径
         self.logPath: str = str(workPath.joinpath(
             "{}.{}.log.tmp".format(mName, lName)))  # 执行过程中的log文件
         self.status: TargetStatus = TargetStatus.notStarted
+        self.reachDiff: set = None  # 修剪后不再可达的target，cgd失败时为None
 
     def __eq__(self, __value) -> bool:
         if __value == None:
@@ -129,18 +128,8 @@ class Worker():
         cmd = ["tiny", self.t.mbcPath, "-o="+self.t.mmbcPath, "-a=t"]
         return self.checkRes(self.runCmd(cmd, self.t.Data["b_apiStr"]))
 
-    def getLinkedModule(self):
-        cmd = ["llvm-link-14", self.t.mmbcPath, self.t.lbcPath, ]
-
-        p = self.runCmd(cmd, getStdOut=True)
-        stdOut = p[1]
-        cmd2 = ["opt-14", "-globaldce", "-mem2reg", "-mergereturn", "-simplifycfg", "-loops", "-lcssa",
-                "-loop-simplify", "-scalar-evolution", "-licm", "-loop-rotate", "-indvars", "-loop-reduce", "-o", self.t.linkedbcPath]
-
-        return self.checkRes(self.runCmd(cmd2, stdOut))
-
     def PreAnalysis(self):
-        cmd = ["pa", "-field-limit=512000", "-model-consts=true", "-main="+self.t.mmbcPath, "-lib="+self.t.lbcPath, "-linked="+self.t.linkedbcPath,
+        cmd = ["pa", "-field-limit=512000", "-model-consts=true", "-main="+self.t.mmbcPath, "-lib="+self.t.lbcPath,
                "-o="+self.t.csmbcPath]
 
         return self.checkRes(self.runCmd(cmd))
@@ -152,13 +141,17 @@ class Worker():
 
         return self.checkRes(self.runCmd(cmd))
 
+    # 一次cgd运行同时输出修剪后的callgraph与修剪前后target的可达性差异
     def getCGR(self):
-        cmd = ["cgd", self.t.conbcPath, "-r=true", "-o="+self.t.cgrPath]
-        return self.checkRes(self.runCmd(cmd))
-
-    def getCGO(self):
-        cmd = ["cgd", self.t.conbcPath, "-o="+self.t.cgoPath]
-        return self.checkRes(self.runCmd(cmd))
+        cmd = ["cgd", self.t.conbcPath, "-r=true", "-diff",
+               "-targets=magma_bug*", "-o="+self.t.cgrPath]
+        p, stdout = self.runCmd(cmd, getStdOut=True)
+        output = stdout.decode(errors="replace")
+        self.logFd.write(output)
+        if not self.checkRes((p, stdout)):
+            return False
+        self.t.reachDiff = parseReachDiff(output)
+        return True
 
     def runCmd(self, cmd, input=None, getStdOut=False):
         def setlimits():
@@ -176,16 +169,12 @@ class Worker():
     def start(self):
         if not self.getMainModule():
             return
-        if not self.getLinkedModule():
-            return
         if not self.PreAnalysis():
             return
         if not self.ConstantProp():
             return
         if not self.getCGR():
             return
-        if not self.getCGO():
-            return
 
         self.logFd.close()
         self.t.status = TargetStatus.exitedNormal
@@ -276,6 +265,15 @@ def diffCG(cgrPath, cgoPath):
     print("\treachDiff:{}".format(diffSet))
 
 
+# 从cgd -diff的输出中取出修剪后可达性改变的target
+def parseReachDiff(output: str):
+    diffSet = set()
+    for line in output.splitlines():
+        if line.startswith("target ") and line.endswith(",changed"):
+            diffSet.add(line.split(":")[0][len("target "):])
+    return diffSet
+
+
 def postFuncDump(t: Target):
     print("{},{},apiCount:{},callerSize:{},addrTaker:{}".format(t.mbcPath, t.lbcPath, t.Data["apiCount"],
                                                                 t.Data["callerSize"], t.Data["addrTaker"]))
@@ -315,8 +313,10 @@ def postFuncT2(t: Target):
     global indexCounter
     print("{} log:{}".format(indexCounter, t.logPath))
     print("\tstatus:{}\n".format(t.status))
-    if t.status == TargetStatus.exitedNormal:
-        diffCG(t.cgrPath, t.cgoPath)
+    if t.status == TargetStatus.exitedNormal and getattr(t, "reachDiff", None) is not None:
+        print("\treachDiff:{}".format(t.reachDiff))
+    else:
+        print("\treachDiff:failed, see {}".format(t.logPath))
 
     indexCounter += 1
 
@@ -356,7 +356,6 @@ def postFuncClean(t: Target):
     remove(t.csmbcPath)
     remove(t.conbcPath)
     remove(t.cgrPath)
-    remove(t.cgoPath)
     remove(t.logPath)
     t.status = TargetStatus.notStarted
 